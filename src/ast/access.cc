@@ -33,6 +33,7 @@ VerifyResult Access::VerifyType(Context *ctx) {
                    operand->VerifyType(ctx));
 
   auto base_type = DereferenceAll(operand_result.type_);
+  std::string name(member_name.get());
   if (base_type == type::Type_) {
     if (!operand_result.const_) {
       ctx->error_log_.NonConstantTypeMemberAccess(span);
@@ -48,13 +49,13 @@ VerifyResult Access::VerifyType(Context *ctx) {
     // clear that this is supposed to be a member so we should emit an error but
     // carry on assuming that this is an element of that enum type.
     if (auto *e = evaled_type->if_as<type::Enum>()) {
-      if (!e->Get(member_name).has_value()) {
-        ctx->error_log_.MissingMember(span, member_name, evaled_type);
+      if (!e->Get(name).has_value()) {
+        ctx->error_log_.MissingMember(span, name, evaled_type);
       }
       return VerifyResult::Constant(ctx->set_type(this, evaled_type));
     } else if (auto *f = evaled_type->if_as<type::Flags>()) {
-      if (!f->Get(member_name).has_value()) {
-        ctx->error_log_.MissingMember(span, member_name, evaled_type);
+      if (!f->Get(name).has_value()) {
+        ctx->error_log_.MissingMember(span, name, evaled_type);
       }
       return VerifyResult::Constant(ctx->set_type(this, evaled_type));
     } else {
@@ -65,9 +66,9 @@ VerifyResult Access::VerifyType(Context *ctx) {
     }
 
   } else if (auto *s = base_type->if_as<type::Struct>()) {
-    auto const *member = s->field(member_name);
+    auto const *member = s->field(name);
     if (member == nullptr) {
-      ctx->error_log_.MissingMember(span, member_name, s);
+      ctx->error_log_.MissingMember(span, name, s);
       return VerifyResult::Error();
     }
 
@@ -76,7 +77,7 @@ VerifyResult Access::VerifyType(Context *ctx) {
                      [](ast::Hashtag h) {
                        return h.kind_ == ast::Hashtag::Builtin::Export;
                      })) {
-      ctx->error_log_.NonExportedMember(span, member_name, s);
+      ctx->error_log_.NonExportedMember(span, name, s);
     }
     return VerifyResult(ctx->set_type(this, member->type),
                         operand_result.const_);
@@ -97,7 +98,7 @@ VerifyResult Access::VerifyType(Context *ctx) {
     // TODO is this right?
     return VerifyResult::Constant(ctx->set_type(this, t));
   } else {
-    ctx->error_log_.MissingMember(span, member_name, base_type);
+    ctx->error_log_.MissingMember(span, name, base_type);
     return VerifyResult::Error();
   }
 }
@@ -115,7 +116,8 @@ base::vector<ir::RegisterOr<ir::Addr>> ast::Access::EmitLVal(Context *ctx) {
 
   ASSERT(t, Is<type::Struct>());
   auto *struct_type = &t->as<type::Struct>();
-  return {ir::Field(reg, struct_type, struct_type->index(member_name))};
+  return {ir::Field(reg, struct_type,
+                    struct_type->index(std::string(member_name.get())))};
 }
 
 base::vector<ir::Val> ast::Access::EmitIR(Context *ctx) {
@@ -129,10 +131,12 @@ base::vector<ir::Val> ast::Access::EmitIR(Context *ctx) {
 
   auto *this_type = ctx->type_of(this);
   if (this_type->is<type::Enum>()) {
-    auto lit = this_type->as<type::Enum>().EmitLiteral(member_name);
+    auto lit = this_type->as<type::Enum>().EmitLiteral(
+        std::string(member_name.get()));
     return {ir::Val(lit)};
   } else if (this_type->is<type::Flags>()) {
-    auto lit = this_type->as<type::Flags>().EmitLiteral(member_name);
+    auto lit = this_type->as<type::Flags>().EmitLiteral(
+        std::string(member_name.get()));
     return {ir::Val(lit)};
   } else {
     auto lval = EmitLVal(ctx)[0];
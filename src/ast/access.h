@@ -3,12 +3,13 @@
 
 #include <string>
 #include "ast/expression.h"
+#include "symbol.h"
 
 namespace ast {
 struct Access : public Expression {
   ~Access() override {}
   std::string to_string(size_t n) const override {
-    return operand->to_string(n) + "." + member_name;
+    return operand->to_string(n) + "." + std::string(member_name.get());
   }
 
   void assign_scope(Scope *scope) override;
@@ -22,7 +23,7 @@ struct Access : public Expression {
   base::vector<ir::Val> EmitIR(Context *) override;
   base::vector<ir::RegisterOr<ir::Addr>> EmitLVal(Context *) override;
 
-  std::string member_name;
+  Symbol member_name;
   std::unique_ptr<Expression> operand;
 };
 
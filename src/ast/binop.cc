@@ -133,9 +133,9 @@ VerifyResult Binop::VerifyType(Context *ctx) {
       if (t->is<type::Struct>()) {
         FnArgs<Expression *> args;
         args.pos_ = base::vector<Expression *>{{lhs.get()}};
-        OverloadSet os(scope_, "as", ctx);
-        os.add_adl("as", t);
-        os.add_adl("as", lhs_result.type_);
+        OverloadSet os(scope_, sym, ctx);
+        os.add_adl(sym, t);
+        os.add_adl(sym, lhs_result.type_);
         os.keep_return(t);
 
         auto *ret_type = DispatchTable::MakeOrLogError(this, args, os, ctx);
@@ -182,7 +182,7 @@ VerifyResult Binop::VerifyType(Context *ctx) {
         return VerifyResult::Error();
       }
 
-#define CASE(OpName, symbol, return_type)                                      \
+#define CASE(OpName, return_type)                                              \
   case Operator::OpName: {                                                     \
     bool is_const = lhs_result.const_ && rhs_result.const_;                    \
     if (type::IsNumeric(lhs_result.type_) &&                                   \
@@ -196,9 +196,9 @@ VerifyResult Binop::VerifyType(Context *ctx) {
     } else {                                                                   \
       FnArgs<Expression *> args;                                               \
       args.pos_ = base::vector<Expression *>{{lhs.get(), rhs.get()}};          \
-      OverloadSet os(scope_, symbol, ctx);                                     \
-      os.add_adl(symbol, lhs_result.type_);                                    \
-      os.add_adl(symbol, rhs_result.type_);                                    \
+      OverloadSet os(scope_, sym, ctx);                                        \
+      os.add_adl(sym, lhs_result.type_);                                       \
+      os.add_adl(sym, rhs_result.type_);                                       \
                                                                                \
       auto *ret_type = DispatchTable::MakeOrLogError(this, args, os, ctx);     \
       if (ret_type == nullptr) { return VerifyResult::Error(); }               \
@@ -206,14 +206,14 @@ VerifyResult Binop::VerifyType(Context *ctx) {
       return VerifyResult(ctx->set_type(this, ret_type), lhs_result.const_);   \
     }                                                                          \
   } break;
-      CASE(Sub, "-", lhs_result.type_);
-      CASE(Mul, "-", lhs_result.type_);
-      CASE(Div, "/", lhs_result.type_);
-      CASE(Mod, "%", lhs_result.type_);
-      CASE(SubEq, "-=", type::Void());
-      CASE(MulEq, "*=", type::Void());
-      CASE(DivEq, "/=", type::Void());
-      CASE(ModEq, "%=", type::Void());
+      CASE(Sub, lhs_result.type_);
+      CASE(Mul, lhs_result.type_);
+      CASE(Div, lhs_result.type_);
+      CASE(Mod, lhs_result.type_);
+      CASE(SubEq, type::Void());
+      CASE(MulEq, type::Void());
+      CASE(DivEq, type::Void());
+      CASE(ModEq, type::Void());
 #undef CASE
     case Operator::Add: {
       bool is_const = lhs_result.const_ && rhs_result.const_;
@@ -228,9 +228,9 @@ VerifyResult Binop::VerifyType(Context *ctx) {
       } else {
         FnArgs<Expression *> args;
         args.pos_ = base::vector<Expression *>{{lhs.get(), rhs.get()}};
-        OverloadSet os(scope_, "+", ctx);
-        os.add_adl("+", lhs_result.type_);
-        os.add_adl("+", rhs_result.type_);
+        OverloadSet os(scope_, sym, ctx);
+        os.add_adl(sym, lhs_result.type_);
+        os.add_adl(sym, rhs_result.type_);
 
         auto *ret_type = DispatchTable::MakeOrLogError(this, args, os, ctx);
         if (ret_type == nullptr) { return VerifyResult::Error(); }
@@ -251,9 +251,9 @@ VerifyResult Binop::VerifyType(Context *ctx) {
       } else {
         FnArgs<Expression *> args;
         args.pos_ = base::vector<Expression *>{{lhs.get(), rhs.get()}};
-        OverloadSet os(scope_, "+=", ctx);
-        os.add_adl("+=", lhs_result.type_);
-        os.add_adl("+=", rhs_result.type_);
+        OverloadSet os(scope_, sym, ctx);
+        os.add_adl(sym, lhs_result.type_);
+        os.add_adl(sym, rhs_result.type_);
 
         auto *ret_type = DispatchTable::MakeOrLogError(this, args, os, ctx);
         if (ret_type == nullptr) { return VerifyResult::Error(); }
@@ -560,8 +560,8 @@ base::vector<ir::RegisterOr<ir::Addr>> ast::Binop::EmitLVal(Context *ctx) {
         // TODO interim until you remove string_view and replace it with Addr
         // entirely.
         return {ir::PtrIncr(
-            ir::GetString(std::string(
-                std::get<std::string_view>(lhs->EmitIR(ctx)[0].value))),
+            ir::GetString(
+                std::get<std::string_view>(lhs->EmitIR(ctx)[0].value)),
             rhs->EmitIR(ctx)[0].reg_or<i32>(), type::Ptr(type::Nat8))};
       }
       [[fallthrough]];
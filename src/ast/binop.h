@@ -8,6 +8,7 @@
 #include "ast/expression.h"
 #include "frontend/operators.h"
 #include "ir/val.h"
+#include "symbol.h"
 
 struct Scope;
 struct Context;
@@ -25,6 +26,9 @@ struct Binop : public Expression {
   base::vector<ir::RegisterOr<ir::Addr>> EmitLVal(Context *) override;
 
   Language::Operator op;
+  // The operator as spelled in the source, interned once at parse time so
+  // that overload resolution can look it up directly.
+  Symbol sym;
   std::unique_ptr<Expression> lhs, rhs;
 };
 
@@ -0,0 +1,98 @@
+#include "ast/bound_constants.h"
+
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "ast/declaration.h"
+#include "base/guarded.h"
+#include "base/hash.h"
+#include "scope.h"
+
+namespace ast {
+namespace {
+// Alternatives without a `std::hash` specialization contribute only which
+// alternative they are. Bindings whose hashes collide are compared in full
+// anyway.
+size_t HashVal(ir::Val const &val) {
+  size_t value_hash = std::visit(
+      [](auto const &v) -> size_t {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_default_constructible_v<std::hash<T>>) {
+          return std::hash<T>{}(v);
+        } else {
+          return 0;
+        }
+      },
+      val.value);
+  return base::hash_args(val.type, val.value.index(), value_hash);
+}
+
+struct InternTable {
+  struct Entry {
+    size_t hash_;
+    // The module declaring the constants bound, or null if the id is free.
+    Module const *mod_;
+    base::map<Declaration const *, ir::Val> constants_;
+  };
+
+  // Keyed on the hash of each set of bindings.
+  std::unordered_multimap<size_t, u32> ids_;
+  // The set with id `i` is at index `i - 1`. The empty set is never stored.
+  std::vector<Entry> entries_;
+  // Ids of sets forgotten along with their module, to be handed out again.
+  std::vector<u32> free_ids_;
+};
+base::guarded<InternTable> intern_table;
+}  // namespace
+
+u32 BoundConstants::Intern() const {
+  if (constants_.empty()) { return 0; }
+
+  size_t hash = 0;
+  for (auto const & [ decl, val ] : constants_) {
+    hash = base::hash_args(hash, decl, HashVal(val));
+  }
+
+  auto handle       = intern_table.lock();
+  auto[first, last] = handle->ids_.equal_range(hash);
+  for (; first != last; ++first) {
+    if (handle->entries_[first->second - 1].constants_ == constants_) {
+      return first->second;
+    }
+  }
+
+  // The constants bound are the parameters of one generic, so all are
+  // declared in the same module.
+  InternTable::Entry entry{hash, constants_.begin()->first->scope_->module(),
+                           constants_};
+  u32 id;
+  if (handle->free_ids_.empty()) {
+    handle->entries_.push_back(std::move(entry));
+    id = static_cast<u32>(handle->entries_.size());
+  } else {
+    id = handle->free_ids_.back();
+    handle->free_ids_.pop_back();
+    handle->entries_[id - 1] = std::move(entry);
+  }
+  handle->ids_.emplace(hash, id);
+  return id;
+}
+
+void ForgetBoundConstants(Module const *mod) {
+  auto handle = intern_table.lock();
+  for (u32 id = 1; id <= handle->entries_.size(); ++id) {
+    auto &entry = handle->entries_[id - 1];
+    if (entry.mod_ != mod) { continue; }
+    auto[first, last] = handle->ids_.equal_range(entry.hash_);
+    for (; first != last; ++first) {
+      if (first->second != id) { continue; }
+      handle->ids_.erase(first);
+      break;
+    }
+    entry = InternTable::Entry{0, nullptr, {}};
+    handle->free_ids_.push_back(id);
+  }
+}
+}  // namespace ast
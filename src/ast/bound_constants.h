@@ -1,31 +1,67 @@
 #ifndef ICARUS_AST_BOUND_CONSTANTS_H
 #define ICARUS_AST_BOUND_CONSTANTS_H
 
+#include <limits>
+
 #include "base/container/map.h"
 #include "base/string.h"
+#include "base/types.h"
 #include "ir/val.h"
 
+struct Module;
+
 namespace ast {
 struct Declaration;
 
+// The values bound to the constant parameters of a generic, for one
+// instantiation of it. Each distinct set of bindings is interned in a table
+// shared by every module, which gives it a small integer id. Data which
+// depends on the instantiation is keyed on that id, so looking it up never
+// compares values. The empty set always has id 0.
 struct BoundConstants {
-  base::map<Declaration const*, ir::Val> constants_;
+  using const_iterator =
+      base::map<Declaration const *, ir::Val>::const_iterator;
+
+  bool empty() const { return constants_.empty(); }
+  const_iterator begin() const { return constants_.begin(); }
+  const_iterator end() const { return constants_.end(); }
+  const_iterator find(Declaration const *decl) const {
+    return constants_.find(decl);
+  }
+  ir::Val const &at(Declaration const *decl) const {
+    return constants_.at(decl);
+  }
+
+  void emplace(Declaration const *decl, ir::Val val) {
+    if (constants_.emplace(decl, std::move(val)).second) { id_ = kNotInterned; }
+  }
+
+  // Interns these bindings the first time it is called after they change.
+  u32 id() const {
+    if (id_ == kNotInterned) { id_ = Intern(); }
+    return id_;
+  }
 
   // TODO blah.
   std::string to_string() const {
     return base::internal::stringify(constants_);
   }
-};
-}  // namespace ast
 
-namespace std {
-template <>
-struct less<ast::BoundConstants> {
-  bool operator()(const ast::BoundConstants& lhs,
-                  const ast::BoundConstants& rhs) const {
-    return (lhs.constants_ < rhs.constants_);
-  }
+ private:
+  static constexpr u32 kNotInterned = std::numeric_limits<u32>::max();
+
+  u32 Intern() const;
+
+  base::map<Declaration const *, ir::Val> constants_;
+  // Cached, since interning hashes every value. Computed lazily, since
+  // bindings are built up one at a time.
+  mutable u32 id_ = 0;
 };
-}  // namespace std
+
+// Forgets every set of bindings for constants declared in `mod`, so that their
+// ids may be reused. Called as `mod` is destroyed, along with everything which
+// could still hold one of those ids.
+void ForgetBoundConstants(Module const *mod);
+}  // namespace ast
 
 #endif  // ICARUS_AST_BOUND_CONSTANTS_H
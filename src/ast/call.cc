@@ -168,7 +168,7 @@ VerifyResult Call::VerifyType(Context *ctx) {
 
   OverloadSet overload_set = [&]() {
     if (fn_->is<Identifier>()) {
-      auto &token = fn_->as<Identifier>().token;
+      Symbol token = fn_->as<Identifier>().token;
       OverloadSet os(scope_, token, ctx);
       arg_results.Apply(
           [&](VerifyResult const &v) { os.add_adl(token, v.type_); });
@@ -48,7 +48,7 @@ ir::RegisterOr<bool> EmitChainOpPair(ast::ChainOp *chain_op, size_t index,
 
     auto results = ASSERT_NOT_NULL(ctx->rep_dispatch_tables(chain_op))
                        ->at(index)
-                       .EmitCall(args, type::Bool, ctx);
+                       ->EmitCall(args, type::Bool, ctx);
     ASSERT(results.size() == 1u);
     return results[0].reg_or<bool>();
 
@@ -226,25 +226,14 @@ not_blocks:
         // TODO struct is wrong. generally user-defined (could be array of
         // struct too, or perhaps a variant containing a struct?) need to
         // figure out the details here.
-        const char *token = nullptr;
-        switch (ops[i]) {
-          case Language::Operator::Lt: token = "<"; break;
-          case Language::Operator::Le: token = "<="; break;
-          case Language::Operator::Eq: token = "=="; break;
-          case Language::Operator::Ne: token = "!="; break;
-          case Language::Operator::Ge: token = ">="; break;
-          case Language::Operator::Gt: token = ">"; break;
-          default: UNREACHABLE();
-        }
-
         if (lhs_result.type_->is<type::Struct>() || lhs_result.type_->is<type::Struct>()) {
           FnArgs<Expression *> args;
           args.pos_ =
               base::vector<Expression *>{{exprs[i].get(), exprs[i + 1].get()}};
           // TODO overwriting type a bunch of times?
-          OverloadSet os(scope_, token, ctx);
-          os.add_adl(token, lhs_result.type_);
-          os.add_adl(token, rhs_result.type_);
+          OverloadSet os(scope_, syms[i], ctx);
+          os.add_adl(syms[i], lhs_result.type_);
+          os.add_adl(syms[i], rhs_result.type_);
 
           auto *ret_type = DispatchTable::MakeOrLogError(this, args, os, ctx, true);
           if (ret_type == nullptr) { return VerifyResult::Error(); }
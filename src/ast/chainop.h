@@ -6,6 +6,7 @@
 #include "ast/expression.h"
 #include "base/container/vector.h"
 #include "frontend/operators.h"
+#include "symbol.h"
 
 namespace ast {
 struct ChainOp : public Expression {
@@ -21,6 +22,8 @@ struct ChainOp : public Expression {
   base::vector<ir::RegisterOr<ir::Addr>> EmitLVal(Context *) override;
 
   base::vector<Language::Operator> ops;
+  // The spelling of each operator in `ops`, interned at parse time.
+  base::vector<Symbol> syms;
   base::vector<std::unique_ptr<Expression>> exprs;
 };
 }  // namespace ast
@@ -171,7 +171,8 @@ bool Shadow(Declaration *decl1, Declaration *decl2, Context *ctx) {
         auto *input_type = ctx->type_of(eval->inputs_.at(i).value.get());
         metadata.push_back(ArgumentMetaData{
             /*        type = */ input_type,
-            /*        name = */ eval->inputs_.at(i).value->id_,
+            /*        name = */
+            std::string(eval->inputs_.at(i).value->id_.get()),
             /* has_default = */
             !eval->inputs_.at(i).value->IsDefaultInitialized()});
       }
@@ -308,6 +309,7 @@ VerifyResult VerifySpecialFunctions(Declaration const *decl,
 }
 
 VerifyResult Declaration::VerifyType(Context *ctx) {
+  auto claim = ctx->mod_->ClaimOwnerOf(this);
   bool swap_bc = ctx->mod_ != mod_;
   Module *old_mod = std::exchange(ctx->mod_, mod_);
   BoundConstants old_bc;
@@ -459,7 +461,7 @@ VerifyResult Declaration::VerifyType(Context *ctx) {
       if (this_type == type::Module) {
         // TODO check shadowing against other modules?
         // TODO what if no init val is provded? what if not constant?
-        scope_->embedded_modules_.insert(
+        scope_->EmbedModule(
             backend::EvaluateAs<Module const *>(init_val.get(), ctx));
         return VerifyResult::Constant(type::Module);
       } else if (this_type->is<type::Tuple>()) {
@@ -474,21 +476,15 @@ VerifyResult Declaration::VerifyType(Context *ctx) {
   ASSERT(this_type != nullptr) << this;
   base::vector<type::Typed<Declaration *>> decls_to_check;
   {
-    auto good_decls_to_check = scope_->AllDeclsWithId(id_, ctx);
-    size_t num_total         = good_decls_to_check.size();
-    auto iter                = scope_->child_decls_.find(id_);
+    auto const &good_decls_to_check = scope_->AllDeclsWithId(id_);
+    auto nested_decls               = scope_->NestedDeclsWithId(id_);
 
-    bool has_children = (iter != scope_->child_decls_.end());
-    if (has_children) { num_total += iter->second.size(); }
-
-    decls_to_check.reserve(num_total);
-    decls_to_check.insert(decls_to_check.end(), good_decls_to_check.begin(),
-                          good_decls_to_check.end());
-
-    if (has_children) {
-      for (auto *decl : iter->second) {
-        decls_to_check.emplace_back(decl, ctx->type_of(decl));
-      }
+    decls_to_check.reserve(good_decls_to_check.size() + nested_decls.size());
+    for (auto const &decl : good_decls_to_check) {
+      decls_to_check.emplace_back(decl.get(), DeclType(decl, ctx));
+    }
+    for (auto *decl : nested_decls) {
+      decls_to_check.emplace_back(decl, ctx->type_of(decl));
     }
   }
 
@@ -510,6 +506,7 @@ VerifyResult Declaration::VerifyType(Context *ctx) {
     // higher-up-the-scope-tree identifier as the shadow when something else on
     // a different branch could find it unambiguously. It's also just a hack
     // from the get-go so maybe we should just do it the right way.
+    auto claim_all = ctx->mod_->ClaimAll();
     scope_->shadowed_decls_.insert(id_);
     return VerifyResult::Error();
   }
@@ -518,6 +515,7 @@ VerifyResult Declaration::VerifyType(Context *ctx) {
 }
 
 void Declaration::Validate(Context *ctx) {
+  auto claim = ctx->mod_->ClaimOwnerOf(this);
   bool swap_bc = ctx->mod_ != mod_;
   Module *old_mod = std::exchange(ctx->mod_, mod_);
   BoundConstants old_bc;
@@ -552,10 +550,10 @@ base::vector<ir::Val> ast::Declaration::EmitIR(Context *ctx) {
 
   if (const_) {
     if (is_fn_param_) {
-      return {ctx->bound_constants_.constants_.at(this)};
+      return {ctx->bound_constants_.at(this)};
     } else {
       auto[iter, newly_inserted] =
-          ctx->mod_->constants_[ctx->bound_constants_].constants_.emplace(
+          ctx->mod_->constants_[ctx->bound_constants_.id()].emplace(
               this, ir::Val::None());
       if (!newly_inserted) { return {iter->second}; }
 
@@ -566,7 +564,7 @@ base::vector<ir::Val> ast::Declaration::EmitIR(Context *ctx) {
       } else if (IsDefaultInitialized()) {
         if (is_fn_param_) {
           return {
-              ctx->mod_->constants_[ctx->bound_constants_].constants_.at(this)};
+              ctx->mod_->constants_[ctx->bound_constants_.id()].at(this)};
         } else {
           NOT_YET(this);
         }
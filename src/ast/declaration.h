@@ -3,6 +3,7 @@
 
 #include "ast/expression.h"
 #include "ir/register.h"
+#include "symbol.h"
 
 struct Module;
 namespace ir {
@@ -25,7 +26,7 @@ struct Declaration : public Expression {
   base::vector<ir::Val> EmitIR(Context *) override;
   base::vector<ir::RegisterOr<ir::Addr>> EmitLVal(Context *) override { UNREACHABLE(this); }
 
-  std::string id_;
+  Symbol id_;
   std::unique_ptr<Expression> type_expr, init_val;
 
   Module *mod_ = nullptr;
@@ -1,12 +1,15 @@
 #include "ast/dispatch.h"
 
+#include <numeric>
 #include <variant>
 
 #include "ast/call.h"
 #include "ast/function_literal.h"
+#include "ast/instantiations.h"
 #include "ast/match_declaration.h"
 #include "ast/terminal.h"
 #include "backend/eval.h"
+#include "base/hash.h"
 #include "context.h"
 #include "ir/cmd.h"
 #include "ir/components.h"
@@ -209,6 +212,9 @@ struct DispatchTableRow {
   FnArgs<type::Type const *> call_arg_types_;
   type::Callable const *callable_type_ = nullptr;
   Binding binding_;
+  // Whether the row binds the values of constant arguments, rather than just
+  // their types.
+  bool generic_ = false;
 
  private:
   static base::expected<DispatchTableRow, CallObstruction> MakeNonConstant(
@@ -256,7 +262,7 @@ CallObstruction DispatchTableRow::SetTypes(
         // it does NOT have a default value.
         Declaration &decl = *params.at(entry.parameter_index).value;
         if (decl.IsDefaultInitialized()) {
-          return CallObstruction::NoDefault(decl.id_);
+          return CallObstruction::NoDefault(decl.id_.get());
         }
         // TODO The order for evaluating these is wrong. Defaults may need to be
         // intermixed with non-defaults.
@@ -266,7 +272,7 @@ CallObstruction DispatchTableRow::SetTypes(
         input_type = result.type_;
 
         decl.Validate(ctx);
-        ctx->bound_constants_.constants_.emplace(
+        ctx->bound_constants_.emplace(
             &decl, backend::Evaluate(decl.init_val.get(), ctx)[0]);
 
       } else if constexpr (std::is_same_v<E, Expression *>) {
@@ -429,6 +435,9 @@ DispatchTableRow::MakeFromFnLit(
     type::Typed<Expression *, type::Callable> fn_option,
     FunctionLiteral *fn_lit, FnArgs<type::Typed<Expression *>> const &args,
     Context *ctx) {
+  // Instantiating verifies the literal, so it is claimed along with the
+  // declaration containing it.
+  auto claim = ctx->mod_->ClaimOwnerOf(fn_lit);
   ASSIGN_OR(return _.error(), auto binding,
                    MakeBinding(fn_option, fn_lit->inputs_, args, ctx));
 
@@ -446,13 +455,13 @@ DispatchTableRow::MakeFromFnLit(
     // constant. Is that a hard error or do we just ignore this case? Similarly
     // below for named and default arguments.
     if (needs_match_decl) {
-      new_ctx.bound_constants_.constants_.emplace(
+      new_ctx.bound_constants_.emplace(
           &fn_lit->inputs_.at(i).value->type_expr->as<MatchDeclaration>(),
           ir::Val(args.pos_.at(i).type()));
     }
 
     if (fn_lit->inputs_.at(i).value->const_) {
-      new_ctx.bound_constants_.constants_.emplace(
+      new_ctx.bound_constants_.emplace(
           fn_lit->inputs_.at(i).value.get(),
           backend::Evaluate(args.pos_.at(i).get(), ctx)[0]);
     }
@@ -461,7 +470,7 @@ DispatchTableRow::MakeFromFnLit(
     size_t index = fn_lit->inputs_.lookup_[name];
     auto *decl   = fn_lit->inputs_.at(index).value.get();
     if (!decl->const_) { continue; }
-    new_ctx.bound_constants_.constants_.emplace(
+    new_ctx.bound_constants_.emplace(
         decl, backend::Evaluate(expr.get(), ctx)[0]);
     // TODO Match decls?
   }
@@ -474,7 +483,7 @@ DispatchTableRow::MakeFromFnLit(
     auto *decl = fn_lit->inputs_.at(index).value.get();
     decl->init_val->VerifyType(&new_ctx);
     decl->init_val->Validate(&new_ctx);
-    new_ctx.bound_constants_.constants_.emplace(
+    new_ctx.bound_constants_.emplace(
         decl, backend::Evaluate(decl->init_val.get(), &new_ctx)[0]);
   }
 
@@ -482,7 +491,12 @@ DispatchTableRow::MakeFromFnLit(
   // TODO named arguments too.
   auto *fn_type = &ASSERT_NOT_NULL(fn_lit->VerifyTypeConcrete(&new_ctx).type_)
                        ->as<type::Callable>();
-  fn_lit->Validate(&new_ctx);
+  // A published instantiation was validated by the module which completed it,
+  // and its body will not be emitted again.
+  if (FindInstantiation(fn_lit, new_ctx.bound_constants_, ctx->mod_) ==
+      nullptr) {
+    fn_lit->Validate(&new_ctx);
+  }
   binding.fn_.set_type(fn_type);
 
   DispatchTableRow dispatch_table_row(std::move(binding));
@@ -498,6 +512,7 @@ DispatchTableRow::MakeFromFnLit(
   }
   dispatch_table_row.binding_.bound_constants_ =
       std::move(new_ctx).bound_constants_;
+  dispatch_table_row.generic_ = true;
   return dispatch_table_row;
 }
 
@@ -564,9 +579,46 @@ static type::Type const *ComputeRetType(
   return type::Tup(std::move(combined_outputs));
 }
 
-std::pair<DispatchTable, type::Type const *> DispatchTable::Make(
-    FnArgs<type::Typed<Expression *>> const &args,
-    OverloadSet const &overload_set, Context *ctx) {
+DispatchSignature::DispatchSignature(
+    OverloadSet const &overload_set,
+    FnArgs<type::Typed<Expression *>> const &args) {
+  overloads_.reserve(overload_set.size());
+  for (auto const &overload : overload_set) {
+    overloads_.push_back(overload.get());
+    hash_ = base::hash_args(hash_, overload.get());
+  }
+  arg_types_.reserve(args.pos_.size());
+  for (auto const &arg : args.pos_) {
+    arg_types_.push_back(arg.type());
+    hash_ = base::hash_args(hash_, arg.type());
+  }
+}
+
+std::pair<std::shared_ptr<DispatchTable const>, type::Type const *>
+DispatchTable::Make(FnArgs<type::Typed<Expression *>> const &args,
+                    OverloadSet const &overload_set, Context *ctx) {
+  // A table depends only on the overloads, the bound constants and the types
+  // of the arguments, so long as none are named (the entries for those are
+  // found by name) or expanded (which depends on the expression). Generic
+  // overloads also bind the values of constant arguments, so tables which
+  // have any are never cached. Nor are those made in a nested context, whose
+  // lookups may fall back on its parent's bound constants.
+  bool cacheable = ctx->parent_ == nullptr && args.named_.empty() &&
+                   std::none_of(args.pos_.begin(), args.pos_.end(),
+                                [](type::Typed<Expression *> const &arg) {
+                                  return arg.get()->needs_expansion();
+                                });
+  auto &cache = ctx->mod_->data(ctx->bound_constants_).dispatch_cache_;
+  DispatchSignature signature;
+  if (cacheable) {
+    signature = DispatchSignature(overload_set, args);
+    auto lock = ctx->mod_->LockData();
+    if (auto iter = cache.find(signature); iter != cache.end()) {
+      return iter->second;
+    }
+  }
+  size_t num_errors = ctx->num_errors();
+
   DispatchTable table;
 
   // TODO Immovable default arguments are not handled here, nor can they be
@@ -580,7 +632,10 @@ std::pair<DispatchTable, type::Type const *> DispatchTable::Make(
       error = true;
     }
   });
-  if (error) { return std::pair{std::move(table), nullptr}; }
+  if (error) {
+    return std::pair{std::make_shared<DispatchTable const>(std::move(table)),
+                     nullptr};
+  }
 
   base::vector<type::Callable const *> precise_callable_types;
   for (auto &overload : overload_set) {
@@ -602,13 +657,14 @@ std::pair<DispatchTable, type::Type const *> DispatchTable::Make(
               .is<CallObstruction::CascadingErrorData>()) {
         // TODO return from this function by some mechanism indicating that we
         // gave up because there were errors resolving the call.
-        return {};
+        return std::pair{std::make_shared<DispatchTable const>(), nullptr};
       }
       table.failure_reasons_.emplace(
           overload.get(), maybe_dispatch_table_row.error().to_string());
       continue;
     }
 
+    cacheable &= !maybe_dispatch_table_row->generic_;
     maybe_dispatch_table_row->binding_.fn_.set_type(
         maybe_dispatch_table_row->callable_type_);
     // TODO don't ned this as a field on the dispatchtablerow.
@@ -622,7 +678,13 @@ std::pair<DispatchTable, type::Type const *> DispatchTable::Make(
   // itself. Probably put in in a row.
   type::Type const *ret_type = ComputeRetType(precise_callable_types);
 
-  return std::pair{std::move(table), ret_type};
+  std::pair result{std::make_shared<DispatchTable const>(std::move(table)),
+                   ret_type};
+  if (cacheable && ctx->num_errors() == num_errors) {
+    auto lock = ctx->mod_->LockData();
+    cache.emplace(std::move(signature), result);
+  }
+  return result;
 }
 
 static void AddPositionalType(type::Type const *t,
@@ -696,10 +758,10 @@ type::Type const *DispatchTable::MakeOrLogError(
   });
 
   auto[table, ret_type] = Make(typed_args, overload_set, ctx);
-  if (table.bindings_.empty()) {
+  if (table->bindings_.empty()) {
     // TODO what about operators?
-    ctx->error_log_.NoCallMatch(node->span, table.generic_failure_reasons_,
-                                table.failure_reasons_);
+    ctx->error_log_.NoCallMatch(node->span, table->generic_failure_reasons_,
+                                table->failure_reasons_);
     return nullptr;
   }
 
@@ -708,7 +770,7 @@ type::Type const *DispatchTable::MakeOrLogError(
       expanded.begin(), expanded.end(),
       [&](FnArgs<type::Type const *> const &fnargs) {
         return std::any_of(
-            table.bindings_.begin(), table.bindings_.end(),
+            table->bindings_.begin(), table->bindings_.end(),
             [&fnargs](auto const &kv) { return Covers(kv.first, fnargs); });
       });
   expanded.erase(new_end_iter, expanded.end());
@@ -731,8 +793,9 @@ type::Type const *DispatchTable::MakeOrLogError(
 // return value.
 static void EmitOneCallDispatch(
     type::Type const *ret_type, base::vector<ir::Val> *outgoing_regs,
+    FnArgs<std::pair<Expression *, base::vector<ir::Val>>> const &emitted_args,
     base::unordered_map<Expression *, base::vector<ir::Val> const *> const
-        &expr_map,
+        &named_vals,
     Binding const &binding, Context *ctx) {
   auto callee = [&] {
     Context fn_ctx(ctx->mod_);  // TODO this might be the wrong module.
@@ -769,13 +832,22 @@ static void EmitOneCallDispatch(
                     ->PrepareArgument(ctx->type_of(default_expr),
                                       default_expr->EmitIR(ctx)[0], ctx);
     } else {
+      // Positional arguments are found by index, since the binding may have
+      // been made for another call. See `Binding::Entry::expr`.
+      Expression *expr                  = entry.expr;
+      base::vector<ir::Val> const *vals = nullptr;
+      if (entry.argument_index == -1) {
+        vals = named_vals.at(expr);
+      } else {
+        auto const &arg = emitted_args.pos_.at(entry.argument_index);
+        expr            = arg.first;
+        vals            = &arg.second;
+      }
       auto *t = (entry.expansion_index == -1)
-                    ? ctx->type_of(entry.expr)
-                    : ctx->type_of(entry.expr)
-                          ->as<type::Tuple>()
-                          .entries_.at(entry.expansion_index);
-      auto const &val =
-          expr_map.at(entry.expr)->at(std::max(0, entry.expansion_index));
+                    ? ctx->type_of(expr)
+                    : ctx->type_of(expr)->as<type::Tuple>().entries_.at(
+                          entry.expansion_index);
+      auto const &val = vals->at(std::max(0, entry.expansion_index));
       args[i] = ASSERT_NOT_NULL(entry.type)->PrepareArgument(t, val, ctx);
     }
   }
@@ -852,37 +924,6 @@ static void EmitOneCallDispatch(
   ir::Call(callee.reg_or<ir::AnyFunc>(), std::move(call_args), std::move(outs));
 }
 
-static ir::RegisterOr<bool> EmitVariantMatch(ir::Register needle,
-                                             type::Type const *haystack) {
-  auto runtime_type = ir::Load<type::Type const *>(ir::VariantType(needle));
-
-  if (haystack->is<type::Variant>()) {
-    // TODO I'm fairly confident this will work, but it's also overkill because
-    // we may already know this type matches if one variant is a subset of the
-    // other.
-    auto landing = ir::Func::Current->AddBlock();
-
-    base::unordered_map<ir::BlockIndex, ir::RegisterOr<bool>> phi_map;
-    for (type::Type const *v : haystack->as<type::Variant>().variants_) {
-      phi_map.emplace(ir::BasicBlock::Current, true);
-
-      ir::BasicBlock::Current =
-          ir::EarlyExitOn<true>(landing, ir::Eq(v, runtime_type));
-    }
-
-    phi_map.emplace(ir::BasicBlock::Current, false);
-
-    ir::UncondJump(landing);
-
-    ir::BasicBlock::Current = landing;
-    return ir::MakePhi<bool>(ir::Phi(type::Bool), phi_map);
-
-  } else {
-    // TODO actually just implicitly convertible to haystack
-    return ir::Eq(haystack, runtime_type);
-  }
-}
-
 // Small contains expanded arguments (no variants).
 bool Covers(FnArgs<type::Type const *> const &big,
             FnArgs<type::Type const *> const &small) {
@@ -906,45 +947,78 @@ bool Covers(FnArgs<type::Type const *> const &big,
   return true;
 }
 
-static ir::BlockIndex CallLookupTest(
-    FnArgs<std::pair<Expression *, base::vector<ir::Val>>> const &args,
-    FnArgs<type::Type const *> const &call_arg_type, Context *ctx) {
-  // Generate code that attempts to match the types on each argument (only
-  // check the ones at the call-site that could be variants).
-  
-  // TODO enable variant dispatch on arguments that got expanded.
-  auto next_binding = ir::Func::Current->AddBlock();
-  for (size_t i = 0; i < args.pos_.size(); ++i) {
-    if (!ctx->type_of(args.pos_[i].first)->is<type::Variant>()) { continue; }
-    ir::BasicBlock::Current = ir::EarlyExitOn<false>(
-        next_binding, EmitVariantMatch(std::get<ir::Register>(
-                                           args.pos_.at(i).second[0].value),
-                                       call_arg_type.pos_[i]));
+namespace {
+// An argument at the call site whose type is a variant, and so on which the
+// choice of binding may depend.
+struct VariantArg {
+  ir::Register addr_;
+  type::Variant const *type_;
+  size_t index_;                      // Only meaningful if positional.
+  std::string const *name_ = nullptr;  // Null if positional.
+
+  // Returns whether a binding with argument types `call_arg_type` can be
+  // called when this argument holds a `t`.
+  bool Accepts(FnArgs<type::Type const *> const &call_arg_type,
+               type::Type const *t) const {
+    type::Type const *bound = nullptr;
+    if (name_ == nullptr) {
+      bound = call_arg_type.pos_.at(index_);
+    } else {
+      auto iter = call_arg_type.find(*name_);
+      if (iter == call_arg_type.named_.end()) { return true; }
+      bound = iter->second;
+    }
+    if (bound == t) { return true; }
+    auto *vt = bound->if_as<type::Variant>();
+    return vt != nullptr && vt->contains(t);
   }
+};
+
+// Emits the tests choosing which of the bindings to call, as a tree with one
+// level per variant argument. Each level loads the type the argument holds
+// and jumps straight to the subtree for that type. The first of `candidates`
+// consistent with every type on the way down is chosen, as is the last
+// binding if none are. Returns the block at the root of the tree.
+struct DispatchTree {
+  template <typename Fn>
+  ir::BlockIndex Emit(size_t depth, base::vector<size_t> const &candidates,
+                      Fn const &binding_block) {
+    if (candidates.size() <= 1 || depth == variant_args_.size()) {
+      return binding_block(candidates.empty() ? bindings_.size() - 1
+                                              : candidates[0]);
+    }
 
-  for (const auto & [ name, expr_and_val ] : args.named_) {
-    auto iter = call_arg_type.find(name);
-    if (iter == call_arg_type.named_.end()) { continue; }
-    if (!ctx->type_of(expr_and_val.first)->is<type::Variant>()) { continue; }
-    ir::BasicBlock::Current = ir::EarlyExitOn<false>(
-        next_binding,
-        EmitVariantMatch(
-            std::get<ir::Register>(args.named_.at(iter->first).second[0].value),
-            iter->second));
+    auto const &arg = variant_args_[depth];
+    ir::TypeJumpTable jump_table;
+    for (type::Type const *v : arg.type_->variants_) {
+      base::vector<size_t> accepting;
+      for (size_t i : candidates) {
+        if (arg.Accepts(bindings_[i]->first, v)) { accepting.push_back(i); }
+      }
+      jump_table.emplace_back(v, Emit(depth + 1, accepting, binding_block));
+    }
+
+    auto block              = ir::Func::Current->AddBlock();
+    ir::BasicBlock::Current = block;
+    ir::TypeJump(ir::Load<type::Type const *>(ir::VariantType(arg.addr_)),
+                 std::move(jump_table));
+    return block;
   }
 
-  return next_binding;
-}
+  base::vector<VariantArg> variant_args_;
+  base::vector<base::map<FnArgs<type::Type const *>, Binding>::const_iterator>
+      bindings_;
+};
+}  // namespace
 
 base::vector<ir::Val> DispatchTable::EmitCall(
     FnArgs<std::pair<Expression *, base::vector<ir::Val>>> const &args,
     type::Type const *ret_type, Context *ctx) const {
   ASSERT(bindings_.size() != 0u);
-  base::unordered_map<Expression *, base::vector<ir::Val> const *> expr_map;
-  args.Apply(
-      [&expr_map](std::pair<Expression *, base::vector<ir::Val>> const &arg) {
-        expr_map[arg.first] = &arg.second;
-      });
+  base::unordered_map<Expression *, base::vector<ir::Val> const *> named_vals;
+  for (auto const & [ name, expr_and_vals ] : args.named_) {
+    named_vals[expr_and_vals.first] = &expr_and_vals.second;
+  }
 
   base::vector<ir::Val> out_regs;
   if (ret_type->is<type::Tuple>()) {
@@ -962,7 +1036,7 @@ base::vector<ir::Val> DispatchTable::EmitCall(
 
   if (bindings_.size() == 1) {
     const auto & [ call_arg_type, binding ] = *bindings_.begin();
-    EmitOneCallDispatch(ret_type, &out_regs, expr_map, binding, ctx);
+    EmitOneCallDispatch(ret_type, &out_regs, args, named_vals, binding, ctx);
     return out_regs;
   }
 
@@ -974,36 +1048,55 @@ base::vector<ir::Val> DispatchTable::EmitCall(
   base::vector<base::unordered_map<ir::BlockIndex, ir::Val>> result_phi_args(
       num_rets);
 
-  auto landing_block = ir::Func::Current->AddBlock();
+  DispatchTree tree;
+  for (auto iter = bindings_.begin(); iter != bindings_.end(); ++iter) {
+    tree.bindings_.push_back(iter);
+  }
+  for (size_t i = 0; i < args.pos_.size(); ++i) {
+    // TODO enable variant dispatch on arguments that got expanded.
+    auto *t = ctx->type_of(args.pos_[i].first);
+    if (!t->is<type::Variant>()) { continue; }
+    tree.variant_args_.push_back(VariantArg{
+        std::get<ir::Register>(args.pos_.at(i).second[0].value),
+        &t->as<type::Variant>(), i});
+  }
+  for (auto const & [ name, expr_and_val ] : args.named_) {
+    auto *t = ctx->type_of(expr_and_val.first);
+    if (!t->is<type::Variant>()) { continue; }
+    tree.variant_args_.push_back(
+        VariantArg{std::get<ir::Register>(expr_and_val.second[0].value),
+                   &t->as<type::Variant>(), 0, &name});
+  }
 
-  auto iter = bindings_.begin();
-  ASSERT(iter != bindings_.end());
-  for (size_t i = 0; i < bindings_.size() - 1; ++i, ++iter) {
-    const auto & [ call_arg_type, binding ] = *iter;
-    auto next_binding = CallLookupTest(args, call_arg_type, ctx);
-    size_t j          = 0;
+  auto start_block   = ir::BasicBlock::Current;
+  auto landing_block = ir::Func::Current->AddBlock();
 
-    EmitOneCallDispatch(ret_type, &out_regs, expr_map, binding, ctx);
+  // The block calling each binding, emitted the first time the tree reaches
+  // it.
+  base::unordered_map<size_t, ir::BlockIndex> binding_blocks;
+  auto binding_block = [&](size_t i) {
+    auto[iter, inserted] = binding_blocks.emplace(i, ir::BlockIndex{});
+    if (!inserted) { return iter->second; }
+    iter->second = ir::BasicBlock::Current = ir::Func::Current->AddBlock();
+
+    EmitOneCallDispatch(ret_type, &out_regs, args, named_vals,
+                        tree.bindings_[i]->second, ctx);
+    size_t j = 0;
     for (const auto &result : out_regs) {
       result_phi_args.at(j)[ir::BasicBlock::Current] = result;
       ++j;
     }
     ASSERT(j == num_rets);
-
     ir::UncondJump(landing_block);
-    ir::BasicBlock::Current = next_binding;
-  }
+    return iter->second;
+  };
 
-  const auto & [ call_arg_type, binding ] = *iter;
-  size_t j                                = 0;
-  EmitOneCallDispatch(ret_type, &out_regs, expr_map, binding, ctx);
-  for (const auto &result : out_regs) {
-    result_phi_args.at(j)[ir::BasicBlock::Current] = result;
-    ++j;
-  }
-  ASSERT(j == num_rets);
+  base::vector<size_t> candidates(bindings_.size());
+  std::iota(candidates.begin(), candidates.end(), 0);
+  auto root_block = tree.Emit(0, candidates, binding_block);
 
-  ir::UncondJump(landing_block);
+  ir::BasicBlock::Current = start_block;
+  ir::UncondJump(root_block);
   ir::BasicBlock::Current = landing_block;
 
   switch (num_rets) {
@@ -1,6 +1,7 @@
 #ifndef ICARUS_AST_DISPATCH_H
 #define ICARUS_AST_DISPATCH_H
 
+#include <memory>
 #include <string>
 #include <variant>
 
@@ -45,6 +46,9 @@ struct Binding {
 
     constexpr bool defaulted() const { return expr == nullptr; }
 
+    // For positional arguments, this is the argument of the call the table
+    // was made for, which need not be the call it is emitted for. Emit the
+    // argument at `argument_index` of the call instead.
     Expression *expr = nullptr;
     int argument_index = -1;  // Positive numbers indicate positional arguments.
                               // -1 indicates named argument.
@@ -70,13 +74,36 @@ struct Binding {
       bound_constants_;  // TODO don't copy these. Use some sitting on a module.
 };
 
+// What a cacheable dispatch table depends on, besides the bound constants it
+// was made with: the overloads considered and the types of the positional
+// arguments. See `DispatchTable::Make`.
+struct DispatchSignature {
+  DispatchSignature() = default;
+  DispatchSignature(OverloadSet const &overload_set,
+                    FnArgs<type::Typed<Expression *>> const &args);
+
+  base::vector<Expression const *> overloads_;
+  base::vector<type::Type const *> arg_types_;
+  size_t hash_ = 0;
+};
+
+inline bool operator==(DispatchSignature const &lhs,
+                       DispatchSignature const &rhs) {
+  return lhs.hash_ == rhs.hash_ && lhs.overloads_ == rhs.overloads_ &&
+         lhs.arg_types_ == rhs.arg_types_;
+}
+
 struct DispatchTable {
   // TODO come up with a good internal representaion.
   // * Can/should this be balanced to find the right type-check sequence in a
   //   streaming manner?
   // * Add weights for PGO optimizations?
 
-  static std::pair<DispatchTable, type::Type const *> Make(
+  // Tables are never modified once made, and one may be shared by every call
+  // with the same signature. Bindings refer to the positional arguments of a
+  // call by index, so `EmitCall` emits the arguments of the call it is given.
+  static std::pair<std::shared_ptr<DispatchTable const>, type::Type const *>
+  Make(
       FnArgs<type::Typed<Expression *>> const &args,
       OverloadSet const &overload_set, Context *ctx);
   static type::Type const *MakeOrLogError(Node *node,
@@ -96,4 +123,13 @@ struct DispatchTable {
 
 }  // namespace ast
 
+namespace std {
+template <>
+struct hash<ast::DispatchSignature> {
+  size_t operator()(ast::DispatchSignature const &signature) const {
+    return signature.hash_;
+  }
+};
+}  // namespace std
+
 #endif  // ICARUS_AST_DISPATCH_H
@@ -106,10 +106,10 @@ base::vector<ir::Val> EnumLiteral::EmitIR(Context *ctx) {
   auto reg = ir::CreateEnum(kind_, ctx->mod_);
   for (auto &elem : elems_) {
     if (elem->is<Identifier>()) {
-      ir::AddEnumerator(kind_, reg, elem->as<Identifier>().token);
+      ir::AddEnumerator(kind_, reg, elem->as<Identifier>().token.get());
     } else if (elem->is<Declaration>()) {
       auto &decl = elem->as<Declaration>();
-      ir::AddEnumerator(kind_, reg, decl.id_);
+      ir::AddEnumerator(kind_, reg, decl.id_.get());
       if (!decl.init_val->is<Hole>()) {
         ir::SetEnumerator(reg, decl.init_val->EmitIR(ctx)[0].reg_or<i32>());
       }
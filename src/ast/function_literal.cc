@@ -3,6 +3,7 @@
 #include <sstream>
 #include "ast/bound_constants.h"
 #include "ast/declaration.h"
+#include "ast/instantiations.h"
 #include "ast/match_declaration.h"
 #include "ast/terminal.h"
 #include "backend/eval.h"
@@ -15,6 +16,11 @@
 #include "type/tuple.h"
 #include "type/type.h"
 
+namespace frontend {
+std::unique_ptr<ast::Statements> ParseFunctionBody(TextSpan const &contents,
+                                                   Context *ctx);
+}  // namespace frontend
+
 namespace ast {
 std::string FunctionLiteral::to_string(size_t n) const {
   std::stringstream ss;
@@ -131,9 +137,15 @@ void FunctionLiteral::Validate(Context *ctx) {
     return;
   }
 
-  auto &validated_fns = ctx->mod_->data_[ctx->bound_constants_].validated_;
-  bool inserted = validated_fns.insert(this).second;
-  if (!inserted) { return; }
+  // An unparsed body is verified along with everything else when the function
+  // is completed.
+  if (unparsed_body_) { return; }
+
+  {
+    auto lock = ctx->mod_->LockData();
+    auto &validated_fns = ctx->mod_->data(ctx->bound_constants_).validated_;
+    if (!validated_fns.insert(this).second) { return; }
+  }
 
   for (auto &in : inputs_.params_) { in.value->Validate(ctx); }
   for (auto &out : outputs_) { out->Validate(ctx); }
@@ -245,18 +257,22 @@ base::vector<ir::Val> FunctionLiteral::EmitIR(Context *ctx) {
             // match-decls.
             return (
                 (decl.value->const_ &&
-                 ctx->bound_constants_.constants_.find(decl.value.get()) ==
-                     ctx->bound_constants_.constants_.end()) ||
+                 ctx->bound_constants_.find(decl.value.get()) ==
+                     ctx->bound_constants_.end()) ||
                 (decl.value->type_expr != nullptr &&
                  decl.value->type_expr->template is<MatchDeclaration>() &&
-                 ctx->bound_constants_.constants_.find(
+                 ctx->bound_constants_.find(
                      &decl.value->type_expr->template as<MatchDeclaration>()) ==
-                     ctx->bound_constants_.constants_.end()));
+                     ctx->bound_constants_.end()));
           })) {
     return {ir::Val::Func(this)};
   }
 
-  ir::Func *&ir_func = ctx->mod_->data_[ctx->bound_constants_].ir_funcs_[this];
+  ir::Func *&ir_func = ctx->mod_->data(ctx->bound_constants_).ir_funcs_[this];
+  if (!ir_func && !ctx->bound_constants_.empty()) {
+    // Reuse the instantiation another module has already completed, if any.
+    ir_func = FindInstantiation(this, ctx->bound_constants_, ctx->mod_);
+  }
   if (!ir_func) {
     auto &work_item =
         ctx->mod_->to_complete_.emplace(ctx->bound_constants_, this, ctx->mod_);
@@ -270,18 +286,42 @@ base::vector<ir::Val> FunctionLiteral::EmitIR(Context *ctx) {
     ir_func = ctx->mod_->AddFunc(&ctx->type_of(this)->as<type::Function>(),
                                  std::move(params));
     ir_func->work_item = &work_item;
+    ir_func->span_     = &span;
   }
 
   return {ir::Val::Func(ir_func->type_, ir_func)};
 }
 
+bool FunctionLiteral::ParseBody(Context *ctx) {
+  if (!unparsed_body_) { return true; }
+  auto stmts = frontend::ParseFunctionBody(*unparsed_body_, ctx);
+  if (stmts == nullptr) { return false; }
+  unparsed_body_.reset();
+  statements_ = std::move(*stmts);
+  statements_.assign_scope(fn_scope_.get());
+  return true;
+}
+
 void FunctionLiteral::CompleteBody(Context *ctx) {
   // TODO have validate return a bool distinguishing if there are errors and
   // whether or not we can proceed.
 
   auto *t = ctx->type_of(this);
 
-  ir::Func *&ir_func = ctx->mod_->data_[ctx->bound_constants_].ir_funcs_[this];
+  ir::Func *&ir_func = ctx->mod_->data(ctx->bound_constants_).ir_funcs_[this];
+  if (unparsed_body_) {
+    if (ParseBody(ctx)) { Validate(ctx); }
+    if (ctx->num_errors() > 0) {
+      // The errors have been reported, but the function may still be called
+      // at compile time, so it is marked to be refused when it is.
+      CURRENT_FUNC(ir_func) {
+        ir::BasicBlock::Current = ir_func->entry();
+        ir::ReturnJump();
+      }
+      ir_func->has_errors_ = true;
+      return;
+    }
+  }
   CURRENT_FUNC(ir_func) {
     ir::BasicBlock::Current = ir_func->entry();
     // Leave space for allocas that will come later (added to the entry
@@ -325,7 +365,6 @@ void FunctionLiteral::CompleteBody(Context *ctx) {
 
     ir::BasicBlock::Current = ir_func->entry();
     ir::UncondJump(start_block);
-    ir_func->work_item = nullptr;
   }
 }
 
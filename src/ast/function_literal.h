@@ -1,6 +1,8 @@
 #ifndef ICARUS_AST_FUNCTION_LITERAL_H
 #define ICARUS_AST_FUNCTION_LITERAL_H
 
+#include <optional>
+
 #include "ast/bound_constants.h"
 #include "ast/declaration.h"
 #include "ast/dispatch.h"
@@ -40,6 +42,10 @@ struct FunctionLiteral : public Expression {
 
   void CompleteBody(Context *ctx);
 
+  // Parses the body, if it was skipped over when the rest of the module was
+  // parsed. Returns false if it could not be parsed, having logged an error.
+  bool ParseBody(Context *ctx);
+
   std::unique_ptr<FnScope> fn_scope_;
 
   // TODO This is storing both the name in the declaration and pulls the
@@ -47,6 +53,9 @@ struct FunctionLiteral : public Expression {
   FnParams<std::unique_ptr<Declaration>> inputs_;
   base::vector<std::unique_ptr<Expression>> outputs_;
   Statements statements_;
+  // If set, `statements_` is empty because the body was skipped over, and this
+  // is the span of source between its braces.
+  std::optional<TextSpan> unparsed_body_;
 
   bool return_type_inferred_ = false;
   Module *module_            = nullptr;
@@ -30,19 +30,20 @@ VerifyResult Identifier::VerifyType(Context *ctx) {
 
   type::Type const *t = nullptr;
   if (decl == nullptr) { // TODO I think this is necessarily null
-    auto potential_decls = scope_->AllDeclsWithId(token, ctx);
+    auto const &potential_decls = scope_->AllDeclsWithId(token);
     switch (potential_decls.size()) {
       case 1: {
         // TODO could it be that evn though there is only one declaration,
         // there's a bound constant of the same name? If so, we need to deal
         // with this case.
-        t    = potential_decls[0].type();
+        t    = DeclType(potential_decls[0], ctx);
         decl = potential_decls[0].get();
       } break;
-      case 0:
+      case 0: {
         // TODO what if you find a bound constant and some errror decls?
+        auto lock = ctx->mod_->LockData();
         for (auto const & [ d, v ] :
-             ctx->mod_->constants_[ctx->bound_constants_].constants_) {
+             ctx->mod_->constants_[ctx->bound_constants_.id()]) {
           if (d->id_ == token) {
             return VerifyResult(ctx->set_type(this, v.type), d->const_);
           }
@@ -50,6 +51,7 @@ VerifyResult Identifier::VerifyType(Context *ctx) {
 
         ctx->error_log_.UndeclaredIdentifier(this);
         return VerifyResult::Error();
+      }
       default:
         // TODO Should we allow the overload?
         ctx->error_log_.UnspecifiedOverload(span);
@@ -86,8 +88,8 @@ base::vector<ir::Val> ast::Identifier::EmitIR(Context *ctx) {
                 : ir::Val::Reg(ctx->addr(decl), t)};
   } else if (decl->is<MatchDeclaration>()) {
     // TODO is there a better way to do look up? look up in parent too?
-    if (auto iter = ctx->bound_constants_.constants_.find(decl);
-        iter != ctx->bound_constants_.constants_.end()) {
+    if (auto iter = ctx->bound_constants_.find(decl);
+        iter != ctx->bound_constants_.end()) {
       return {iter->second};
     } else {
       UNREACHABLE(decl);
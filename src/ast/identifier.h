@@ -2,17 +2,20 @@
 #define ICARUS_AST_IDENTIFIER_H
 
 #include "ast/expression.h"
+#include "symbol.h"
 
 namespace ast {
 struct Declaration;
 
 struct Identifier : public Expression {
   Identifier() {}  // TODO needed?
-  Identifier(const TextSpan &span, std::string token)
-      : Expression(span), token(std::move(token)) {}
+  Identifier(const TextSpan &span, Symbol token)
+      : Expression(span), token(token) {}
   ~Identifier() override {}
 
-  std::string to_string(size_t n) const override { return token; }
+  std::string to_string(size_t n) const override {
+    return std::string(token.get());
+  }
   void assign_scope(Scope *scope) override;
 
   VerifyResult VerifyType(Context *) override;
@@ -23,7 +26,7 @@ struct Identifier : public Expression {
   base::vector<ir::Val> EmitIR(Context *) override;
   base::vector<ir::RegisterOr<ir::Addr>> EmitLVal(Context *) override;
 
-  std::string token;
+  Symbol token;
   Declaration *decl = nullptr;
 };
 }  // namespace ast
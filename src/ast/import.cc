@@ -40,11 +40,19 @@ VerifyResult Import::VerifyType(Context *ctx) {
   }
 
   if (err) { return VerifyResult::Error(); }
+  std::filesystem::path src{
+      backend::EvaluateAs<std::string_view>(operand_.get(), ctx)};
+  auto pending_module = Module::Schedule(src, ctx->mod_->path_);
+  if (!pending_module) {
+    if (pending_module.error().empty()) {
+      ctx->error_log_.MissingImport(span, src);
+    } else {
+      ctx->error_log_.CyclicImport(span, pending_module.error());
+    }
+    return VerifyResult::Error();
+  }
   // TODO storing this might not be safe.
-  module_ = Module::Schedule(
-      std::filesystem::path{
-          backend::EvaluateAs<std::string_view>(operand_.get(), ctx)},
-      *ctx->mod_->path_);
+  module_ = *pending_module;
   return VerifyResult::Constant(ctx->set_type(this, type::Module));
 }
 }  // namespace ast
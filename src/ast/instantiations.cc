@@ -0,0 +1,75 @@
+#include "ast/instantiations.h"
+
+#include <unordered_set>
+#include <utility>
+
+#include "ast/struct_literal.h"
+#include "base/container/map.h"
+#include "base/guarded.h"
+#include "ir/func.h"
+
+namespace ast {
+namespace {
+struct InstantiationTable {
+  struct SharedFunc {
+    ir::Func *fn_;
+    // Every module other than the owner of `fn_` which has found it.
+    std::unordered_set<Module const *> users_;
+  };
+  // Keyed on the generic literal and the id of its bound constants. Since ids
+  // are shared by every module, equal bindings from different modules find the
+  // same instantiation.
+  base::map<std::pair<Expression const *, u32>, SharedFunc> fns_;
+  // A node-based map, so that the slots handed out never move.
+  base::map<std::pair<StructLiteral const *, std::string>, type::Type const *>
+      structs_;
+};
+base::guarded<InstantiationTable> instantiations;
+}  // namespace
+
+ir::Func *FindInstantiation(Expression const *generic, BoundConstants const &bc,
+                            Module const *user) {
+  auto handle = instantiations.lock();
+  auto iter   = handle->fns_.find(std::pair{generic, bc.id()});
+  if (iter == handle->fns_.end()) { return nullptr; }
+  if (iter->second.fn_->mod_ != user) { iter->second.users_.insert(user); }
+  return iter->second.fn_;
+}
+
+void PublishInstantiation(Expression const *generic, u32 bc_id, ir::Func *fn) {
+  instantiations.lock()->fns_.emplace(std::pair{generic, bc_id},
+                                      InstantiationTable::SharedFunc{fn, {}});
+}
+
+base::vector<Module const *> InstantiationUsers(Module const *mod) {
+  auto handle = instantiations.lock();
+  std::unordered_set<Module const *> users;
+  for (auto const & [ key, shared ] : handle->fns_) {
+    if (shared.fn_->mod_ != mod) { continue; }
+    users.insert(shared.users_.begin(), shared.users_.end());
+  }
+  return base::vector<Module const *>(users.begin(), users.end());
+}
+
+type::Type const **InstantiatedStructSlot(StructLiteral const *sl,
+                                          std::string args) {
+  auto handle = instantiations.lock();
+  return &handle->structs_[std::pair{sl, std::move(args)}];
+}
+
+void ForgetInstantiations(Module const *mod) {
+  auto handle = instantiations.lock();
+  for (auto iter = handle->fns_.begin(); iter != handle->fns_.end();) {
+    if (iter->second.fn_->mod_ == mod) {
+      iter = handle->fns_.erase(iter);
+    } else {
+      iter->second.users_.erase(mod);
+      ++iter;
+    }
+  }
+  for (auto iter = handle->structs_.begin(); iter != handle->structs_.end();) {
+    iter = iter->first.first->mod_ == mod ? handle->structs_.erase(iter)
+                                          : ++iter;
+  }
+}
+}  // namespace ast
@@ -0,0 +1,55 @@
+#ifndef ICARUS_AST_INSTANTIATIONS_H
+#define ICARUS_AST_INSTANTIATIONS_H
+
+#include <string>
+
+#include "ast/bound_constants.h"
+#include "base/container/vector.h"
+
+struct Module;
+
+namespace ir {
+struct Func;
+}  // namespace ir
+
+namespace type {
+struct Type;
+}  // namespace type
+
+namespace ast {
+struct Expression;
+struct StructLiteral;
+
+// Instantiations of generic function literals and generic structs, shared by
+// every module so that each is only emitted once however many modules use it.
+// All of these may be called from any thread.
+
+// Returns the function instantiating the generic function literal `generic`
+// with the constants bound in `bc`, or null if no module has published one.
+// Records that `user` may now refer to a function owned by another module. See
+// `InstantiationUsers`.
+ir::Func *FindInstantiation(Expression const *generic, BoundConstants const &bc,
+                            Module const *user);
+
+// Publishes `fn` as the instantiation of `generic` with the bound constants
+// whose id is `bc_id`, unless another module published one first. `fn` must
+// have been completed, since any module may execute it from then on.
+void PublishInstantiation(Expression const *generic, u32 bc_id, ir::Func *fn);
+
+// Returns the slot holding the struct type which `sl` evaluates to with the
+// given arguments, or holding null if it has not been evaluated with them yet.
+// `args` holds the bytes of every argument. The slot's address never changes.
+type::Type const **InstantiatedStructSlot(StructLiteral const *sl,
+                                          std::string args);
+
+// Returns every module which has found one of the functions owned by `mod`.
+// These may refer to those functions without importing `mod`, so must be
+// destroyed along with it.
+base::vector<Module const *> InstantiationUsers(Module const *mod);
+
+// Forgets every function owned by `mod`, and every struct instantiated from a
+// literal in `mod`. Called as `mod` is destroyed.
+void ForgetInstantiations(Module const *mod);
+}  // namespace ast
+
+#endif  // ICARUS_AST_INSTANTIATIONS_H
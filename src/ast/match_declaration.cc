@@ -6,7 +6,7 @@
 
 namespace ast {
 std::string MatchDeclaration::to_string(size_t n) const {
-  return type_expr->to_string(n) + "`" + id_;
+  return type_expr->to_string(n) + "`" + std::string(id_.get());
 }
 
 VerifyResult MatchDeclaration::VerifyType(Context *ctx) {
@@ -19,8 +19,8 @@ VerifyResult MatchDeclaration::VerifyType(Context *ctx) {
 void MatchDeclaration::Validate(Context *ctx) { type_expr->Validate(ctx); }
 
 base::vector<ir::Val> MatchDeclaration::EmitIR(Context *ctx) {
-  if (auto iter = ctx->bound_constants_.constants_.find(this);
-      iter != ctx->bound_constants_.constants_.end()) {
+  if (auto iter = ctx->bound_constants_.find(this);
+      iter != ctx->bound_constants_.end()) {
     return {iter->second};
   } else {
   return {ir::Val(
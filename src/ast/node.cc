@@ -0,0 +1,38 @@
+#include "ast/node.h"
+
+#include <new>
+
+namespace ast {
+namespace {
+thread_local base::Arena *current_arena = nullptr;
+
+// Precedes every node, recording the arena it was allocated from (or null if
+// it was allocated from the heap). Sized so that the node which follows it is
+// still suitably aligned.
+struct alignas(base::Arena::kAlignment) AllocationHeader {
+  base::Arena *arena_;
+};
+}  // namespace
+
+void *Node::operator new(size_t size) {
+  size_t total = sizeof(AllocationHeader) + size;
+  void *ptr    = (current_arena != nullptr) ? current_arena->Allocate(total)
+                                         : ::operator new(total);
+  return new (ptr) AllocationHeader{current_arena} + 1;
+}
+
+void Node::operator delete(void *ptr, size_t size) {
+  auto *header = static_cast<AllocationHeader *>(ptr) - 1;
+  if (header->arena_ == nullptr) {
+    ::operator delete(header);
+  } else {
+    header->arena_->Deallocate(header, sizeof(AllocationHeader) + size);
+  }
+}
+
+NodeArenaScope::NodeArenaScope(base::Arena *arena) : previous_(current_arena) {
+  current_arena = arena;
+}
+
+NodeArenaScope::~NodeArenaScope() { current_arena = previous_; }
+}  // namespace ast
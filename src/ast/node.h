@@ -7,12 +7,14 @@
 #include <string>
 #include <type_traits>
 #include <utility>
+#include "base/arena.h"
 #include "base/container/unordered_map.h"
 #include "base/container/vector.h"
 #include "base/untyped_buffer.h"
 
 #include "base/util.h"
 #include "frontend/text_span.h"
+#include "time_passes.h"
 
 struct Context;
 struct Scope;
@@ -61,9 +63,18 @@ struct Node : public base::Cast<Node> {
   virtual base::vector<ir::Val> EmitIR(Context *) = 0;
   virtual void ExtractJumps(JumpExprs *) const    = 0;
 
-  Node(const TextSpan &span = TextSpan()) : span(span) {}
+  Node(const TextSpan &span = TextSpan()) : span(span) {
+    time_passes::Count(time_passes::Counter::AstNodes);
+  }
   virtual ~Node() {}
 
+  // Nodes are allocated from the arena installed on the current thread by a
+  // `NodeArenaScope`, or from the heap if there is none. Deleting a node
+  // returns its memory to wherever it came from, regardless of which arena (if
+  // any) is installed at the time.
+  static void *operator new(size_t size);
+  static void operator delete(void *ptr, size_t size);
+
   std::string to_string() const { return to_string(0); }
 
   inline friend std::ostream &operator<<(std::ostream &os, const Node &node) {
@@ -74,5 +85,17 @@ struct Node : public base::Cast<Node> {
   TextSpan span;
 };
 
+// For as long as it is alive, nodes created on this thread are allocated from
+// `arena`. The arena must outlive every node allocated from it, and nodes
+// allocated from it may not be deleted while another thread is allocating from
+// it.
+struct NodeArenaScope {
+  explicit NodeArenaScope(base::Arena *arena);
+  ~NodeArenaScope();
+
+ private:
+  base::Arena *previous_;
+};
+
 }  // namespace ast
 #endif  // ICARUS_AST_NODE_H
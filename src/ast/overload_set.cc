@@ -5,10 +5,12 @@
 
 namespace ast {
 // TODO only hold functions?
-OverloadSet::OverloadSet(Scope *scope, std::string const &id, Context *ctx) {
-  auto decls = scope->AllDeclsWithId(id, ctx);
+OverloadSet::OverloadSet(Scope *scope, Symbol id, Context *ctx) {
+  auto const &decls = scope->AllDeclsWithId(id);
   reserve(decls.size());
-  for (auto const &decl : decls) { emplace_back(decl.get(), decl.type()); }
+  for (auto const &decl : decls) {
+    emplace_back(decl.get(), DeclType(decl, ctx));
+  }
 }
 
 using base::check::Is;
@@ -34,7 +36,7 @@ void OverloadSet::keep_return(type::Type const *t) {
   this->erase(tail_iter, end());
 }
 
-void OverloadSet::add_adl(std::string const &id, type::Type const *t) {
+void OverloadSet::add_adl(Symbol id, type::Type const *t) {
   std::unordered_set<::Module const *> modules;
   t->defining_modules(&modules);
 
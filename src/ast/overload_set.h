@@ -4,6 +4,7 @@
 #include <string>
 
 #include "base/container/vector.h"
+#include "symbol.h"
 #include "type/typed_value.h"
 #include "type/function.h"
 
@@ -16,9 +17,9 @@ struct Expression;
 struct OverloadSet
     : public base::vector<type::Typed<Expression *, type::Callable>> {
   OverloadSet() = default;
-  OverloadSet(Scope *scope, std::string const &id, Context *ctx);
+  OverloadSet(Scope *scope, Symbol id, Context *ctx);
 
-  void add_adl(std::string const &id, type::Type const *t);
+  void add_adl(Symbol id, type::Type const *t);
 
   void keep_return(type::Type const *t);
 };
@@ -63,8 +63,9 @@ VerifyResult RepeatedUnop::VerifyType(Context *ctx) {
       } else if (arg_type->is<type::Struct>()) {
         FnArgs<Expression *> args;
         args.pos_.push_back(arg.get());
-        OverloadSet os(scope_, "print", ctx);
-        os.add_adl("print", arg_type);
+        static Symbol const kPrint("print");
+        OverloadSet os(scope_, kPrint, ctx);
+        os.add_adl(kPrint, arg_type);
 
         ASSIGN_OR(
             return VerifyResult::Error(), type::Type const &ret_type,
@@ -151,7 +152,7 @@ base::vector<ir::Val> RepeatedUnop::EmitIR(Context *ctx) {
           ast::FnArgs<std::pair<ast::Expression *, base::vector<ir::Val>>> args;
           args.pos_.emplace_back(args_.exprs_[index].get(),
                                  base::vector<ir::Val>{std::move(val)});
-          ASSERT_NOT_NULL(dispatch_tables)->at(index).EmitCall(args, type::Void(), ctx);
+          ASSERT_NOT_NULL(dispatch_tables)->at(index)->EmitCall(args, type::Void(), ctx);
         } else {
           t->EmitRepr(val, ctx);
         }
@@ -91,7 +91,7 @@ base::vector<ir::Val> ast::ScopeNode::EmitIR(Context *ctx) {
     }
   }
 
-  std::unordered_map<std::string, Declaration *> name_lookup;
+  std::unordered_map<Symbol, Declaration *> name_lookup;
   for (auto &decl : scope_lit->decls_) { name_lookup.emplace(decl.id_, &decl); }
 
   struct BlockData {
@@ -152,7 +152,7 @@ base::vector<ir::Val> ast::ScopeNode::EmitIR(Context *ctx) {
     state_type = state_ptr_type->as<type::Pointer>().pointee;
     alloc      = ir::TmpAlloca(state_type, ctx);
     state_type->EmitInit(alloc, ctx);
-    state_id = new Identifier(TextSpan{}, "<scope-state>");
+    state_id = new Identifier(TextSpan{}, Symbol("<scope-state>"));
 
     typed_args.pos_.emplace_back(state_id,
                               ctx->set_type(state_id, state_ptr_type));
@@ -176,7 +176,7 @@ base::vector<ir::Val> ast::ScopeNode::EmitIR(Context *ctx) {
 
   auto[dispatch_table, result_type] =
       DispatchTable::Make(typed_args, init_os, ctx);
-  auto block_seq = dispatch_table.EmitCall(ir_args, result_type, ctx)[0]
+  auto block_seq = dispatch_table->EmitCall(ir_args, result_type, ctx)[0]
                        .reg_or<ir::BlockSequence>();
   ir::BlockSeqJump(block_seq, jump_table);
 
@@ -196,7 +196,7 @@ base::vector<ir::Val> ast::ScopeNode::EmitIR(Context *ctx) {
         DispatchTable::Make(before_expr_args, data.before_os_, ctx);
 
     // TODO args?
-    dispatch_table.EmitCall(before_args, result_type, ctx);
+    dispatch_table->EmitCall(before_args, result_type, ctx);
 
     block.EmitIR(ctx);
     auto yields = std::move(ctx->yields_stack_.back());
@@ -217,7 +217,7 @@ base::vector<ir::Val> ast::ScopeNode::EmitIR(Context *ctx) {
     std::tie(dispatch_table, result_type) =
         DispatchTable::Make(after_expr_args, data.after_os_, ctx);
     auto call_exit_result =
-        dispatch_table.EmitCall(after_args, result_type, ctx)[0]
+        dispatch_table->EmitCall(after_args, result_type, ctx)[0]
             .reg_or<ir::BlockSequence>();
 
     ir::BlockSeqJump(call_exit_result, jump_table);
@@ -243,7 +243,7 @@ base::vector<ir::Val> ast::ScopeNode::EmitIR(Context *ctx) {
     std::tie(dispatch_table, result_type) =
         DispatchTable::Make(expr_args, done_os, ctx);
 
-    auto results = dispatch_table.EmitCall(args, result_type, ctx);
+    auto results = dispatch_table->EmitCall(args, result_type, ctx);
     if (scope_lit->stateful_) { state_type->EmitDestroy(alloc, ctx); }
     return results;
   }
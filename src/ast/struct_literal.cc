@@ -92,7 +92,7 @@ static ir::TypedRegister<type::Type const *> GenerateStruct(
     ir::CreateStructField(
         struct_reg,
         field->type_expr->EmitIR(ctx)[0].reg_or<type::Type const *>());
-    ir::SetStructFieldName(struct_reg, field->id_);
+    ir::SetStructFieldName(struct_reg, field->id_.get());
     for (auto const &hashtag : field->hashtags_) {
       ir::AddHashtagToField(struct_reg, hashtag);
     }
@@ -116,14 +116,16 @@ base::vector<ir::Val> ast::StructLiteral::EmitIR(Context *ctx) {
   //
   // For now, it's safe to do this from within a single module compilation
   // (which is single-threaded).
-  ir::Func *&ir_func = mod_->data_[ctx->bound_constants_].ir_funcs_[this];
+  ir::Func *&ir_func = mod_->data(ctx->bound_constants_).ir_funcs_[this];
   if (!ir_func) {
     auto &work_item =
         ctx->mod_->to_complete_.emplace(ctx->bound_constants_, this, ctx->mod_);
 
     FnParams<Expression *> params;
     params.reserve(args_.size());
-    for (auto const &d : args_) { params.append(d->id_, d->init_val.get()); }
+    for (auto const &d : args_) {
+      params.append(d->id_.get(), d->init_val.get());
+    }
 
     ir_func = mod_->AddFunc(
         type::Func(ctx->type_of(this)->as<type::GenericStruct>().deps_,
@@ -141,7 +143,7 @@ base::vector<ir::RegisterOr<ir::Addr>> ast::StructLiteral::EmitLVal(Context *ctx
 }
 
 void StructLiteral::CompleteBody(Context *ctx) {
-  ir::Func *&ir_func = mod_->data_[ctx->bound_constants_].ir_funcs_[this];
+  ir::Func *&ir_func = mod_->data(ctx->bound_constants_).ir_funcs_[this];
   for (size_t i = 0; i < args_.size(); ++i) {
     ctx->set_addr(args_[i].get(), ir_func->Argument(i));
   }
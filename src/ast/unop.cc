@@ -113,8 +113,9 @@ VerifyResult Unop::VerifyType(Context *ctx) {
       } else if (operand_type->is<type::Struct>()) {
         FnArgs<Expression *> args;
         args.pos_           = base::vector<Expression *>{operand.get()};
-        OverloadSet os(scope_, "-", ctx);
-        os.add_adl("-", operand_type);
+        static Symbol const kSub("-");
+        OverloadSet os(scope_, kSub, ctx);
+        os.add_adl(kSub, operand_type);
 
         auto *ret_type = DispatchTable::MakeOrLogError(this, args, os, ctx);
         if (ret_type == nullptr) { return VerifyResult::Error(); }
@@ -141,8 +142,9 @@ VerifyResult Unop::VerifyType(Context *ctx) {
       if (operand_type->is<type::Struct>()) {
         FnArgs<Expression *> args;
         args.pos_ = base::vector<Expression *>{operand.get()};
-        OverloadSet os(scope_, "!", ctx);
-        os.add_adl("!", operand_type);
+        static Symbol const kNot("!");
+        OverloadSet os(scope_, kNot, ctx);
+        os.add_adl(kNot, operand_type);
 
         auto *ret_type = DispatchTable::MakeOrLogError(this, args, os, ctx);
         if (ret_type == nullptr) { return VerifyResult::Error(); }
@@ -192,6 +192,9 @@ static llvm::Value *EmitCmd(const type::Function *fn_type, LlvmData *llvm_data,
           EmitValue(num_args, llvm_data, cmd.args[0]),
           llvm_data->blocks[std::get<ir::BlockIndex>(cmd.args[1].value).value],
           llvm_data->blocks[std::get<ir::BlockIndex>(cmd.args[2].value).value]);
+    case ir::Op::TypeJump:
+      // TODO lower to a switch on the type pointer.
+      NOT_YET();
     case ir::Op::ReturnJump:
       if (num_rets == 1 && !fn_type->output.at(0)->is_big()) {
         llvm_data->builder->CreateRet(
@@ -4,8 +4,10 @@
 #include "architecture.h"
 #include "ast/expression.h"
 #include "backend/exec.h"
+#include "base/trace.h"
 #include "context.h"
 #include "ir/func.h"
+#include "time_passes.h"
 #include "type/all.h"
 
 namespace backend {
@@ -41,9 +43,71 @@ static std::unique_ptr<ir::Func> ExprFn(
   return fn;
 }
 
+// Compile-time evaluation on each thread shares one `ExecContext`, so that its
+// stack and register buffers are allocated once rather than per evaluation.
+static ExecContext &CompileTimeVM() {
+  thread_local ExecContext vm;
+  return vm;
+}
+
+// Values of these types only exist at compile time, so an expression of one
+// of them can't read or write anything at run time, and has no way to perform
+// I/O. We assume such an expression is pure: that its value depends only on
+// the expression and the constants bound where it is evaluated. Evaluating it
+// again would then give the same result, so we reuse the first one.
+//
+// Results are cached in the module doing the evaluating, which is destroyed
+// (taking the cache with it) whenever a module it imports is. That matters
+// because the cache is keyed on the address of the expression.
+static bool IsCacheable(type::Type const *t) {
+  return t == type::Type_ || t == type::Module || t == type::Scope ||
+         t == type::StatefulScope || t == type::Intf;
+}
+
+static base::untyped_buffer Copy(base::untyped_buffer const &buf) {
+  base::untyped_buffer result(buf.size());
+  result.write(0, buf);
+  return result;
+}
+
 base::untyped_buffer EvaluateToBuffer(type::Typed<ast::Expression *> typed_expr,
                                       Context *ctx) {
-  auto fn = ExprFn(typed_expr, ctx);
+  // Evaluation may emit and complete functions anywhere in the module, so no
+  // other thread may be verifying it meanwhile.
+  auto claim = ctx->mod_->ClaimAll();
+  base::unordered_map<ast::Expression const *, base::untyped_buffer> *cache =
+      nullptr;
+  if (IsCacheable(typed_expr.type())) {
+    cache = &ctx->mod_->data(ctx->bound_constants_).evaluated_;
+    if (auto iter = cache->find(typed_expr.get()); iter != cache->end()) {
+      time_passes::Count(time_passes::Counter::CachedEvaluations);
+      return Copy(iter->second);
+    }
+  }
+
+  time_passes::Count(time_passes::Counter::CompileTimeEvaluations);
+  base::trace::Span span("eval", "evaluate");
+  if (base::trace::enabled) { span.set_detail(typed_expr.get()->to_string(0)); }
+
+  // The IR emitted for an expression depends on its bound constants (which are
+  // folded into it), so functions are kept alongside the rest of the data for
+  // the instantiation. A function emitted with errors is used once and thrown
+  // away.
+  auto &eval_fns = ctx->mod_->data(ctx->bound_constants_).eval_fns_;
+  std::unique_ptr<ir::Func> uncached_fn;
+  ir::Func *fn = nullptr;
+  if (auto iter = eval_fns.find(typed_expr.get());
+      iter != eval_fns.end() &&
+      iter->second->type_->output[0] == typed_expr.type()) {
+    fn = iter->second.get();
+  } else {
+    size_t num_errors = ctx->num_errors();
+    uncached_fn       = ExprFn(typed_expr, ctx);
+    fn                = uncached_fn.get();
+    if (ctx->num_errors() == num_errors) {
+      eval_fns[typed_expr.get()] = std::move(uncached_fn);
+    }
+  }
 
   size_t bytes_needed = Architecture::InterprettingMachine().bytes(typed_expr.type());
   base::untyped_buffer ret_buf(bytes_needed);
@@ -51,8 +115,22 @@ base::untyped_buffer EvaluateToBuffer(type::Typed<ast::Expression *> typed_expr,
   base::vector<ir::Addr> ret_slots;
 
   ret_slots.push_back(ir::Addr::Heap(ret_buf.raw(0)));
-  backend::ExecContext exec_context;
-  Execute(fn.get(), base::untyped_buffer(0), ret_slots, &exec_context);
+  // Evaluations may nest, since executing a function may first require
+  // completing it. Each releases only the stack it allocated.
+  auto &vm          = CompileTimeVM();
+  size_t stack_size = vm.stack_.size();
+  Execute(fn, base::untyped_buffer(0), ret_slots, &vm);
+  vm.stack_.truncate(stack_size);
+  if (std::exchange(vm.failed_, false)) {
+    // The evaluation called a function which failed to compile. Its errors
+    // have been reported, so there's nothing to add, but the result must not
+    // be cached, and zeros are the least surprising garbage to hand back.
+    for (size_t i = 0; i < bytes_needed; ++i) { ret_buf.set(i, char{0}); }
+    return ret_buf;
+  }
+  if (cache != nullptr && ctx->num_errors() == 0) {
+    cache->emplace(typed_expr.get(), Copy(ret_buf));
+  }
   return ret_buf;
 }
 
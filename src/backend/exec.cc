@@ -14,9 +14,11 @@
 #include "ast/block_literal.h"
 #include "ast/expression.h"
 #include "ast/function_literal.h"
+#include "ast/instantiations.h"
 #include "ast/scope_node.h"
 #include "ast/struct_literal.h"
 #include "backend/eval.h"
+#include "backend/profile.h"
 #include "base/util.h"
 #include "error/log.h"
 #include "ir/arguments.h"
@@ -50,15 +52,17 @@ void Execute(ir::Func *fn, const base::untyped_buffer &arguments,
   // explanation here. I'm quite confident this is really possible with the
   // generics model I have, but I can't quite articulate exactly why it only
   // happens for generics and nothing else.
-  if (fn->work_item != nullptr) {
-    std::exchange(fn->work_item, nullptr)->Complete();
+  if (fn->work_item != nullptr) { Module::CompleteFunc(fn); }
+
+  // The function's errors have already been reported, and nothing computed by
+  // calling it would be meaningful. Unwind the whole execution instead.
+  if (fn->has_errors_) {
+    exec_ctx->failed_ = true;
+    return;
   }
 
   // TODO what about bound constants?
-  exec_ctx->call_stack.emplace(fn, arguments);
-
-  // TODO log an error if you're asked to execute a function that had an
-  // error.
+  exec_ctx->PushFrame(fn, arguments);
 
   auto arch     = Architecture::InterprettingMachine();
   size_t offset = 0;
@@ -69,11 +73,15 @@ void Execute(ir::Func *fn, const base::untyped_buffer &arguments,
 
   while (true) {
     auto block_index = exec_ctx->ExecuteBlock(ret_slots);
-    if (block_index.is_default()) {
-      exec_ctx->call_stack.pop();
+    if (exec_ctx->failed_ || block_index.is_default()) {
+      exec_ctx->PopFrame();
       return;
     } else {
-      exec_ctx->call_stack.top().MoveTo(block_index);
+      auto &frame = exec_ctx->call_stack.top();
+      if (exec_ctx->branch_counts_ != nullptr) {
+        exec_ctx->branch_counts_->Record(fn, frame.current_, block_index);
+      }
+      frame.MoveTo(block_index);
     }
   }
 }
@@ -89,14 +97,34 @@ ir::BasicBlock &ExecContext::current_block() {
   return call_stack.top().fn_->block(call_stack.top().current_);
 }
 
-ExecContext::Frame::Frame(ir::Func *fn, const base::untyped_buffer &arguments)
+ExecContext::Frame::Frame(ir::Func *fn, const base::untyped_buffer &arguments,
+                          base::untyped_buffer regs)
     : fn_(fn),
       current_(fn_->entry()),
       prev_(fn_->entry()),
-      regs_(base::untyped_buffer::MakeFull(fn_->reg_size_)) {
+      regs_(std::move(regs)) {
   regs_.write(0, arguments);
 }
 
+void ExecContext::PushFrame(ir::Func *fn,
+                            const base::untyped_buffer &arguments) {
+  if (free_regs_.empty()) {
+    call_stack.emplace(fn, arguments,
+                       base::untyped_buffer::MakeFull(fn->reg_size_));
+    return;
+  }
+  base::untyped_buffer regs = std::move(free_regs_.back());
+  free_regs_.pop_back();
+  regs.truncate(0);
+  regs.pad_to(fn->reg_size_);
+  call_stack.emplace(fn, arguments, std::move(regs));
+}
+
+void ExecContext::PopFrame() {
+  free_regs_.push_back(std::move(call_stack.top().regs_));
+  call_stack.pop();
+}
+
 ir::BlockIndex ExecContext::ExecuteBlock(
     const base::vector<ir::Addr> &ret_slots) {
   ir::BlockIndex result;
@@ -104,7 +132,7 @@ ir::BlockIndex ExecContext::ExecuteBlock(
   auto cmd_iter = current_block().cmds_.begin();
   do {
     result = ExecuteCmd(*cmd_iter++, ret_slots);
-  } while (result == ir::BlockIndex{-2});
+  } while (result == ir::BlockIndex{-2} && !failed_);
   return result;
 }
 
@@ -1026,15 +1054,42 @@ ir::BlockIndex ExecContext::ExecuteCmd(
       save(resolve(cmd.phi_flags_->map_.at(call_stack.top().prev_)));
       break;
     case ir::Op::ArgumentCache: {
-      auto &cache = cmd.sl_->mod_->generic_struct_cache_[cmd.sl_];
-      type::Type const **cache_slot =
-          &cache[resolve<type::Type const *>(ir::Register{0})];
-      save(ir::Addr::Heap(cache_slot));
+      // Keyed on the bytes of every argument.
+      auto arch         = Architecture::InterprettingMachine();
+      auto const &frame = call_stack.top();
+      std::string args;
+      for (size_t i = 0; i < frame.fn_->type_->input.size(); ++i) {
+        auto *t = frame.fn_->type_->input[i];
+        void const *arg =
+            frame.regs_.raw(frame.fn_->Argument(static_cast<u32>(i)).value);
+        if (t->is_big()) {
+          // Big arguments are passed by address. Their values are what matter,
+          // not wherever the caller happened to keep them.
+          auto addr = *static_cast<ir::Addr const *>(arg);
+          switch (addr.kind) {
+            case ir::Addr::Kind::Heap: arg = addr.as_heap; break;
+            case ir::Addr::Kind::Stack: arg = stack_.raw(addr.as_stack); break;
+            case ir::Addr::Kind::ReadOnly:
+              arg = ReadOnlyData.raw(addr.as_rodata);
+              break;
+          }
+        }
+        args.append(static_cast<char const *>(arg), arch.bytes(t));
+      }
+      save(ir::Addr::Heap(
+          ast::InstantiatedStructSlot(cmd.sl_, std::move(args))));
     } break;
     case ir::Op::CondJump:
       return cmd.cond_jump_.blocks_[resolve<bool>(cmd.cond_jump_.cond_)];
     case ir::Op::UncondJump: return cmd.block_;
     case ir::Op::ReturnJump: return ir::BlockIndex{-1};
+    case ir::Op::TypeJump: {
+      auto *t = resolve<type::Type const *>(cmd.type_jump_.type_);
+      for (auto const & [ jump_type, block ] : *cmd.type_jump_.jump_table_) {
+        if (jump_type == t) { return block; }
+      }
+      UNREACHABLE(t);
+    } break;
     case ir::Op::BlockSeqJump: {
       auto bseq = resolve(cmd.block_seq_jump_.bseq_);
 
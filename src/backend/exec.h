@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <stack>
 
+#include "base/container/vector.h"
 #include "base/untyped_buffer.h"
 #include "ir/basic_block.h"
 #include "ir/cmd.h"
@@ -13,12 +14,15 @@ struct Func;
 }  // namespace ir
 
 namespace backend {
+struct BranchCounts;
+
 struct ExecContext {
   ExecContext();
 
   struct Frame {
     Frame() = delete;
-    Frame(ir::Func *fn, const base::untyped_buffer &arguments);
+    Frame(ir::Func *fn, const base::untyped_buffer &arguments,
+          base::untyped_buffer regs);
 
     void MoveTo(ir::BlockIndex block_index) {
       ASSERT(block_index.value >= 0);
@@ -37,6 +41,11 @@ struct ExecContext {
 
   std::stack<Frame> call_stack;
 
+  // Pushes and pops frames, reusing the register buffers of frames which have
+  // returned rather than allocating new ones for every call.
+  void PushFrame(ir::Func *fn, const base::untyped_buffer &arguments);
+  void PopFrame();
+
   ir::BlockIndex ExecuteBlock(const base::vector<ir::Addr> &ret_slots);
   ir::BlockIndex ExecuteCmd(const ir::Cmd &cmd,
                             const base::vector<ir::Addr> &ret_slots);
@@ -50,6 +59,16 @@ struct ExecContext {
   }
 
   base::untyped_buffer stack_;
+
+  // If non-null, every branch taken is counted here.
+  BranchCounts *branch_counts_ = nullptr;
+
+  // Set when execution reaches a function whose body failed to compile. Every
+  // frame then returns without executing anything further.
+  bool failed_ = false;
+
+ private:
+  base::vector<base::untyped_buffer> free_regs_;
 };
 
 void Execute(ir::Func *fn, const base::untyped_buffer &arguments,
@@ -0,0 +1,137 @@
+#include "backend/profile.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+
+#include "base/util.h"
+#include "frontend/text_span.h"
+#include "ir/func.h"
+#include "module.h"
+
+namespace backend {
+char const *profile_output  = nullptr;
+char const *profile_input   = nullptr;
+Profile const *active_profile = nullptr;
+
+namespace {
+// Identifies `fn` across compilations by where it was declared. Returns an
+// empty string if it has no such identity.
+std::string FunctionKey(ir::Func const *fn) {
+  if (fn->span_ == nullptr || fn->mod_ == nullptr ||
+      fn->mod_->path_ == nullptr) {
+    return "";
+  }
+  return fn->mod_->path_->string() + ":" +
+         std::to_string(fn->span_->start.line_num) + ":" +
+         std::to_string(fn->span_->start.offset);
+}
+
+// Returns the number `field` consists of, or nullopt if it is anything else.
+std::optional<u64> ParseCount(std::string const &field) {
+  if (field.empty() || !std::all_of(field.begin(), field.end(), [](char c) {
+        return std::isdigit(static_cast<unsigned char>(c));
+      })) {
+    return std::nullopt;
+  }
+  errno      = 0;
+  u64 result = std::strtoull(field.c_str(), nullptr, 10);
+  if (errno != 0) { return std::nullopt; }
+  return result;
+}
+}  // namespace
+
+void BranchCounts::Record(ir::Func const *fn, ir::BlockIndex from,
+                          ir::BlockIndex to) {
+  switch (fn->blocks_.at(from.value).cmds_.back().op_code_) {
+    case ir::Op::CondJump:
+    case ir::Op::BlockSeqJump:
+    case ir::Op::TypeJump: ++counts_[fn][std::pair{from.value, to.value}]; break;
+    default: break;
+  }
+}
+
+Profile BranchCounts::profile() const {
+  Profile profile;
+  for (auto const & [ fn, counts ] : counts_) {
+    std::string key = FunctionKey(fn);
+    if (key.empty()) { continue; }
+    auto &fn_counts =
+        profile.counts_[std::pair{std::move(key), fn->blocks_.size()}];
+    for (auto const & [ jump, count ] : counts) { fn_counts[jump] += count; }
+  }
+  return profile;
+}
+
+// Each line is a function key, the number of blocks in the function, the
+// blocks jumped from and to, and the number of times that jump was taken, all
+// separated by tabs. The key comes first, since it may contain anything but a
+// newline, and so lines are split from the right when read.
+bool Profile::Write(char const *path) const {
+  std::ofstream os(path);
+  if (!os) { return false; }
+  for (auto const & [ fn_key, counts ] : counts_) {
+    for (auto const & [ jump, count ] : counts) {
+      os << fn_key.first << '\t' << fn_key.second << '\t' << jump.first << '\t'
+         << jump.second << '\t' << count << '\n';
+    }
+  }
+  return static_cast<bool>(os);
+}
+
+std::optional<Profile> Profile::Read(char const *path) {
+  std::ifstream is(path);
+  if (!is) { return std::nullopt; }
+
+  Profile profile;
+  std::string line;
+  while (std::getline(is, line)) {
+    // The number of blocks, the blocks jumped from and to, and the count.
+    std::array<u64, 4> nums;
+    size_t end = line.size();
+    for (size_t i = nums.size(); i > 0; --i) {
+      size_t tab = (end == 0) ? std::string::npos : line.rfind('\t', end - 1);
+      if (tab == std::string::npos) { return std::nullopt; }
+      ASSIGN_OR(return std::nullopt, nums[i - 1],
+                      ParseCount(line.substr(tab + 1, end - tab - 1)));
+      end = tab;
+    }
+    if (nums[1] > std::numeric_limits<i32>::max() ||
+        nums[2] > std::numeric_limits<i32>::max()) {
+      return std::nullopt;
+    }
+    profile.counts_[std::pair{line.substr(0, end), nums[0]}]
+                   [std::pair{static_cast<i32>(nums[1]),
+                              static_cast<i32>(nums[2])}] += nums[3];
+  }
+  if (is.bad()) { return std::nullopt; }
+  return profile;
+}
+
+void Profile::Apply(ir::Func *fn) const {
+  auto iter = counts_.find(std::pair{FunctionKey(fn), fn->blocks_.size()});
+  if (iter == counts_.end()) { return; }
+  auto const &counts = iter->second;
+
+  for (i32 from = 0; from < static_cast<i32>(fn->blocks_.size()); ++from) {
+    auto &block = fn->blocks_[from];
+    if (block.cmds_.empty() || block.cmds_.back().op_code_ != ir::Op::TypeJump) {
+      continue;
+    }
+    auto count = [&](ir::BlockIndex to) -> u64 {
+      auto count_iter = counts.find(std::pair{from, to.value});
+      return count_iter == counts.end() ? 0 : count_iter->second;
+    };
+    for (auto &table : block.jump_tables_) {
+      std::stable_sort(table->begin(), table->end(),
+                       [&](auto const &lhs, auto const &rhs) {
+                         return count(lhs.second) > count(rhs.second);
+                       });
+    }
+  }
+}
+}  // namespace backend
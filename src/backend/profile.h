@@ -0,0 +1,70 @@
+#ifndef ICARUS_BACKEND_PROFILE_H
+#define ICARUS_BACKEND_PROFILE_H
+
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "base/container/map.h"
+#include "base/container/unordered_map.h"
+#include "base/types.h"
+#include "ir/register.h"
+
+namespace ir {
+struct Func;
+}  // namespace ir
+
+namespace backend {
+struct Profile;
+
+// Set by `--profile-generate`. If non-null, running the program counts the
+// branches it takes and writes them to this path.
+extern char const *profile_output;
+
+// Set by `--profile-use`. If non-null, the profile is read from this path and
+// stored in `active_profile` before anything is compiled.
+extern char const *profile_input;
+
+// If non-null, applied to every function once its body is complete. See
+// `Profile::Apply`.
+extern Profile const *active_profile;
+
+// Counts of the jumps taken out of each block, keyed on the function and the
+// blocks jumped from and to. Each function is identified by where it was
+// declared, so that compiling the same source again finds its counts, and by
+// how many blocks it has. Instantiations of a generic function share where
+// they were declared, so the block count tells apart those whose bodies
+// differ.
+struct Profile {
+  // Returns the profile written to `path` by `Write`, or nullopt if it cannot
+  // be read or is malformed.
+  static std::optional<Profile> Read(char const *path);
+
+  // Writes the profile to `path`. Returns whether it succeeded.
+  bool Write(char const *path) const;
+
+  // Reorders the jump table of each `TypeJump` in `fn` so that the types
+  // taken most often are tested first. Does nothing if there are no counts
+  // for `fn`.
+  void Apply(ir::Func *fn) const;
+
+  base::map<std::pair<std::string, size_t>, base::map<std::pair<i32, i32>, u64>>
+      counts_;
+};
+
+// Counts of the jumps out of blocks which end in a choice between more than
+// one successor (a `CondJump`, `BlockSeqJump` or `TypeJump`), keyed on the
+// function and the blocks jumped from and to.
+struct BranchCounts {
+  void Record(ir::Func const *fn, ir::BlockIndex from, ir::BlockIndex to);
+
+  // Returns the counts as a profile. Counts for functions not declared by a
+  // function literal are dropped.
+  Profile profile() const;
+
+  base::unordered_map<ir::Func const *, base::map<std::pair<i32, i32>, u64>>
+      counts_;
+};
+}  // namespace backend
+
+#endif  // ICARUS_BACKEND_PROFILE_H
@@ -0,0 +1,70 @@
+#include "base/test.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "backend/profile.h"
+
+namespace {
+std::string TempPath(std::string const &name) {
+  auto dir = std::filesystem::temp_directory_path() / "profile_test";
+  std::filesystem::create_directories(dir);
+  return (dir / name).string();
+}
+
+// Writes `contents` to a file named `name` and returns its path.
+std::string MakeFile(std::string const &name, std::string const &contents) {
+  auto path = TempPath(name);
+  std::ofstream{path} << contents;
+  return path;
+}
+}  // namespace
+
+TEST(RoundTrip) {
+  backend::Profile profile;
+  profile.counts_[std::pair{"/src/a.ic:3:10", 7}][std::pair{0, 2}] = 5;
+  profile.counts_[std::pair{"/src/a.ic:3:10", 7}][std::pair{0, 3}] = 1;
+  // Instantiations of the same generic function, with different bodies.
+  profile.counts_[std::pair{"/src/a.ic:8:0", 4}][std::pair{1, 2}] = 9;
+  profile.counts_[std::pair{"/src/a.ic:8:0", 6}][std::pair{1, 5}] = 3;
+  // Keys may contain tabs, and counts need not fit in 32 bits.
+  profile.counts_[std::pair{"/src/tab\tbed.ic:1:0", 4}][std::pair{2, 1}] =
+      123456789012;
+
+  auto path = TempPath("round_trip.prof");
+  EXPECT(profile.Write(path.c_str()));
+  auto read = backend::Profile::Read(path.c_str());
+  EXPECT(read.has_value());
+  EXPECT((read.value_or(backend::Profile{}).counts_ == profile.counts_));
+
+  // Writing what was read changes nothing.
+  auto path_again = TempPath("round_trip_again.prof");
+  EXPECT(read.value_or(backend::Profile{}).Write(path_again.c_str()));
+  auto read_again = backend::Profile::Read(path_again.c_str());
+  EXPECT((read_again.value_or(backend::Profile{}).counts_ == profile.counts_));
+}
+
+TEST(Empty) {
+  auto read = backend::Profile::Read(MakeFile("empty.prof", "").c_str());
+  EXPECT(read.has_value());
+  EXPECT(read.value_or(backend::Profile{}).counts_.empty());
+}
+
+TEST(Malformed) {
+  EXPECT(!backend::Profile::Read(TempPath("missing.prof").c_str()).has_value());
+  EXPECT(!backend::Profile::Read(
+              MakeFile("too_few.prof", "/src/a.ic:1:0\t4\t0\t1\n").c_str())
+              .has_value());
+  EXPECT(!backend::Profile::Read(
+              MakeFile("not_a_number.prof", "/src/a.ic:1:0\t4\t0\tx\t2\n")
+                  .c_str())
+              .has_value());
+  EXPECT(!backend::Profile::Read(
+              MakeFile("negative.prof", "/src/a.ic:1:0\t4\t-1\t1\t2\n").c_str())
+              .has_value());
+  EXPECT(!backend::Profile::Read(
+              MakeFile("too_big.prof", "/src/a.ic:1:0\t4\t0\t4294967296\t2\n")
+                  .c_str())
+              .has_value());
+}
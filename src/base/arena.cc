@@ -0,0 +1,42 @@
+#include "base/arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+
+namespace base {
+void *Arena::Allocate(size_t size) {
+  size = RoundUp(std::max<size_t>(size, 1));
+  if (size <= kMaxRecycledSize) {
+    auto &free_list = free_lists_[size / kAlignment];
+    if (free_list != nullptr) {
+      void *result = free_list;
+      free_list    = free_list->next_;
+      return result;
+    }
+  }
+
+  if (static_cast<size_t>(end_ - next_) < size) {
+    size_t block_size = std::max(kMinBlockSize, size);
+    // `new char[]` only guarantees alignment suitable for `char`, so ask for
+    // enough extra room to align the start of the block.
+    blocks_.emplace_back(new char[block_size + kAlignment]);
+    bytes_reserved_ += block_size;
+    auto start = reinterpret_cast<uintptr_t>(blocks_.back().get());
+    next_      = reinterpret_cast<char *>(RoundUp(start));
+    end_       = next_ + block_size;
+  }
+
+  void *result = next_;
+  next_ += size;
+  return result;
+}
+
+void Arena::Deallocate(void *ptr, size_t size) {
+  size = RoundUp(std::max<size_t>(size, 1));
+  if (size > kMaxRecycledSize) { return; }
+  auto &free_list = free_lists_[size / kAlignment];
+  free_list       = new (ptr) FreeNode{free_list};
+}
+}  // namespace base
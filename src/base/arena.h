@@ -0,0 +1,50 @@
+#ifndef ICARUS_BASE_ARENA_H
+#define ICARUS_BASE_ARENA_H
+
+#include <cstddef>
+#include <memory>
+
+#include "base/container/vector.h"
+
+namespace base {
+// A bump allocator. Allocations are carved out of large blocks in the order
+// they are made, and all of them are released together when the arena is
+// destroyed. Memory handed back through `Deallocate` is kept on a free list
+// for its size, to be reused by later allocations of the same size. Not
+// thread-safe.
+struct Arena {
+  static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+  Arena() = default;
+  Arena(Arena const &) = delete;
+  Arena &operator=(Arena const &) = delete;
+
+  void *Allocate(size_t size);
+  void Deallocate(void *ptr, size_t size);
+
+  // Total bytes held in blocks, whether or not they are in use.
+  size_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  static constexpr size_t kMinBlockSize = 64 * 1024;
+  // Freed allocations up to this size are kept for reuse. Larger ones are
+  // rare, and simply stay unused until the arena is destroyed.
+  static constexpr size_t kMaxRecycledSize = 512;
+
+  static constexpr size_t RoundUp(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  struct FreeNode {
+    FreeNode *next_;
+  };
+
+  base::vector<std::unique_ptr<char[]>> blocks_;
+  char *next_ = nullptr;
+  char *end_  = nullptr;
+  size_t bytes_reserved_ = 0;
+  FreeNode *free_lists_[kMaxRecycledSize / kAlignment + 1] = {};
+};
+}  // namespace base
+
+#endif  // ICARUS_BASE_ARENA_H
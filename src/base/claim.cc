@@ -0,0 +1,153 @@
+#include "base/claim.h"
+
+#include <limits>
+
+namespace base {
+void ClaimGroup::Join() {
+  std::lock_guard lock(mu_);
+  // Until it takes a part, a thread holds nothing for others to wait on.
+  taken_.emplace(std::this_thread::get_id(),
+                 std::numeric_limits<size_t>::max());
+  ++running_;
+}
+
+void ClaimGroup::Leave() {
+  std::lock_guard lock(mu_);
+  auto iter = taken_.find(std::this_thread::get_id());
+  if (iter->second < parts_.size()) { ReleaseTaken(iter->second); }
+  taken_.erase(iter);
+  --running_;
+  cv_.notify_all();
+}
+
+void ClaimGroup::ReleaseTaken(size_t index) {
+  auto &owner = parts_[index].owner_;
+  if (owner.load() != std::this_thread::get_id()) { return; }
+  owner.store(std::thread::id{});
+  cv_.notify_all();
+}
+
+size_t ClaimGroup::TakeNext() {
+  std::unique_lock lock(mu_);
+  size_t &taken = taken_.at(std::this_thread::get_id());
+  if (taken < parts_.size()) { ReleaseTaken(taken); }
+  if (next_ == parts_.size()) {
+    taken = parts_.size();
+    return taken;
+  }
+
+  // Taken and claimed without releasing `mu_`, so that no thread working on a
+  // part taken later can claim this one first.
+  taken = next_++;
+  AcquireLocked(&lock, &parts_[taken]);
+  return taken;
+}
+
+bool ClaimGroup::MayBorrow(Part const *part) const {
+  auto me      = std::this_thread::get_id();
+  size_t taken = taken_.at(me);
+  // Each step moves to a different waiting thread, so a chain longer than the
+  // number of waiters can only be a cycle the caller is not part of.
+  for (size_t steps = 0; steps <= waiting_on_.size(); ++steps) {
+    auto owner = part->owner_.load();
+    if (owner == me) { return true; }
+    if (owner == std::thread::id{} || taken_.at(owner) < taken) {
+      return false;
+    }
+    auto iter = waiting_on_.find(owner);
+    if (iter == waiting_on_.end()) { return false; }
+    part = iter->second;
+  }
+  return false;
+}
+
+ClaimGroup::Hold ClaimGroup::Acquire(Part *part) {
+  if (part->owner_.load() == std::this_thread::get_id()) {
+    return Hold::Reentrant;
+  }
+  std::unique_lock lock(mu_);
+  return AcquireLocked(&lock, part);
+}
+
+ClaimGroup::Hold ClaimGroup::AcquireLocked(std::unique_lock<std::mutex> *lock,
+                                           Part *part) {
+  auto me = std::this_thread::get_id();
+  if (part->owner_.load() == std::thread::id{}) {
+    part->owner_.store(me);
+    return Hold::Owned;
+  }
+  if (MayBorrow(part)) { return Hold::Borrowed; }
+
+  // The part's owner is partway through working on it, and must finish before
+  // anyone else may start, even a thread holding the whole structure. Such a
+  // thread gives the structure up while it waits, so that the owner can run,
+  // and takes it back once every other thread is blocked again.
+  bool held_all = all_owner_ == me;
+  if (held_all) { all_owner_ = std::thread::id{}; }
+
+  // Whichever thread goes ahead may be waiting already, and must be woken to
+  // see the cycle this wait closes.
+  waiting_on_.emplace(me, part);
+  --running_;
+  cv_.notify_all();
+  Hold hold = Hold::None;
+  cv_.wait(*lock, [&] {
+    if (all_owner_ != std::thread::id{}) { return false; }
+    if (held_all && running_ != 0) { return false; }
+    if (part->owner_.load() == std::thread::id{}) {
+      hold = Hold::Owned;
+    } else if (MayBorrow(part)) {
+      hold = Hold::Borrowed;
+    }
+    return hold != Hold::None;
+  });
+  waiting_on_.erase(me);
+  ++running_;
+  if (hold == Hold::Owned) { part->owner_.store(me); }
+  if (held_all) { all_owner_ = me; }
+  return hold;
+}
+
+void ClaimGroup::Release(Part *part, Hold hold) {
+  if (hold != Hold::Owned) { return; }
+  std::lock_guard lock(mu_);
+  part->owner_.store(std::thread::id{});
+  cv_.notify_all();
+}
+
+ClaimGroup::Hold ClaimGroup::AcquireAll() {
+  auto me = std::this_thread::get_id();
+  std::unique_lock lock(mu_);
+  if (all_owner_ == me) { return Hold::Reentrant; }
+
+  --running_;
+  cv_.notify_all();
+  cv_.wait(lock,
+           [&] { return all_owner_ == std::thread::id{} && running_ == 0; });
+  all_owner_ = me;
+  ++running_;
+  return Hold::Owned;
+}
+
+void ClaimGroup::ReleaseAll(Hold hold) {
+  if (hold != Hold::Owned) { return; }
+  std::lock_guard lock(mu_);
+  all_owner_ = std::thread::id{};
+  cv_.notify_all();
+}
+
+Claim::Claim(ClaimGroup *group, ClaimGroup::Part *part)
+    : group_(group), part_(part) {
+  if (group_ == nullptr) { return; }
+  hold_ = part_ ? group_->Acquire(part_) : group_->AcquireAll();
+}
+
+Claim::~Claim() {
+  if (group_ == nullptr) { return; }
+  if (part_) {
+    group_->Release(part_, hold_);
+  } else {
+    group_->ReleaseAll(hold_);
+  }
+}
+}  // namespace base
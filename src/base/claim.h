@@ -0,0 +1,96 @@
+#ifndef ICARUS_BASE_CLAIM_H
+#define ICARUS_BASE_CLAIM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace base {
+// Lets a group of threads work through the parts of one structure at once,
+// where each part may only be worked on by one running thread at a time. Each
+// thread takes parts in the order they were added, and works on each with it
+// claimed. Working on one part may need others, which are claimed in turn,
+// blocking while another thread holds them. A thread may also claim the whole
+// structure, blocking until every other thread in the group is blocked.
+//
+// Waiting never deadlocks. If threads end up waiting on each other in a cycle,
+// the one whose current part was added first goes ahead without taking over
+// the part it waits on. The others cannot run again until it releases what it
+// holds, so the part is still only worked on by one running thread, and which
+// thread works through the cycle does not depend on timing. A thread holding
+// the whole structure may claim any part no other thread is working on, but
+// waits like any other for the rest, and gives up the structure meanwhile.
+struct ClaimGroup {
+  struct Part {
+    // Only written with the group's mutex held, but read without it by the
+    // thread which holds the part.
+    std::atomic<std::thread::id> owner_{};
+  };
+
+  // Adds a part to the group. Must not be called once threads have joined.
+  Part *AddPart() { return &parts_.emplace_back(); }
+  size_t size() const { return parts_.size(); }
+
+  // Every thread working on the structure must join the group before it
+  // claims anything, and leave once it is done.
+  void Join();
+  void Leave();
+
+  // Releases the part the calling thread took last, if any, and takes the
+  // next part not yet taken, claimed for the calling thread. Returns its
+  // index, or `size()` once every part has been taken.
+  size_t TakeNext();
+
+ private:
+  friend struct Claim;
+  enum class Hold { None, Owned, Reentrant, Borrowed };
+
+  Hold Acquire(Part *part);
+  // As `Acquire`, with `mu_` held by `lock`.
+  Hold AcquireLocked(std::unique_lock<std::mutex> *lock, Part *part);
+  void Release(Part *part, Hold hold);
+  // Releases the part at `index`, which the calling thread took. `mu_` must be
+  // held.
+  void ReleaseTaken(size_t index);
+  Hold AcquireAll();
+  void ReleaseAll(Hold hold);
+
+  // Whether the calling thread may work on `part` without owning it: `part` is
+  // held by a thread (transitively) waiting on the calling thread, none of
+  // which took its current part before the calling thread did. `mu_` must be
+  // held.
+  bool MayBorrow(Part const *part) const;
+
+  std::deque<Part> parts_;
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  // The number of threads in the group which are not blocked.
+  size_t running_ = 0;
+  size_t next_    = 0;
+  std::thread::id all_owner_{};
+  // The index of the part each thread took last.
+  std::unordered_map<std::thread::id, size_t> taken_;
+  std::unordered_map<std::thread::id, Part const *> waiting_on_;
+};
+
+// Holds a claim for as long as it is alive. A null `group` claims nothing, and
+// a null `part` claims the whole structure.
+struct Claim {
+  Claim() = default;
+  Claim(ClaimGroup *group, ClaimGroup::Part *part);
+  Claim(Claim const &) = delete;
+  Claim &operator=(Claim const &) = delete;
+  ~Claim();
+
+ private:
+  ClaimGroup *group_      = nullptr;
+  ClaimGroup::Part *part_ = nullptr;
+  ClaimGroup::Hold hold_  = ClaimGroup::Hold::None;
+};
+}  // namespace base
+
+#endif  // ICARUS_BASE_CLAIM_H
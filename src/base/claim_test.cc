@@ -0,0 +1,285 @@
+#include "base/test.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/claim.h"
+
+namespace {
+// Blocks each thread calling `Arrive` until `count` of them have.
+struct Barrier {
+  explicit Barrier(size_t count) : count_(count) {}
+
+  void Arrive() {
+    std::unique_lock lock(mu_);
+    if (--count_ == 0) { cv_.notify_all(); }
+    cv_.wait(lock, [this] { return count_ == 0; });
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  size_t count_;
+};
+
+// Records the order in which threads reach some point.
+struct Log {
+  void Append(int n) {
+    std::lock_guard lock(mu_);
+    entries_.push_back(n);
+  }
+
+  std::vector<int> entries() {
+    std::lock_guard lock(mu_);
+    return entries_;
+  }
+
+ private:
+  std::mutex mu_;
+  std::vector<int> entries_;
+};
+
+// Has thread `i` of `threads` take part `i` of `group`. Parts are taken in
+// thread order, so which thread took which part doesn't depend on timing.
+struct TakeInOrder {
+  explicit TakeInOrder(base::ClaimGroup *group) : group_(group) {}
+
+  size_t Take(size_t i) {
+    std::unique_lock lock(mu_);
+    cv_.wait(lock, [&] { return next_ == i; });
+    size_t taken = group_->TakeNext();
+    ++next_;
+    cv_.notify_all();
+    return taken;
+  }
+
+ private:
+  base::ClaimGroup *group_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  size_t next_ = 0;
+};
+}  // namespace
+
+TEST(Owned) {
+  // Each thread claims the same part many times. No two may ever be inside
+  // the claim at once.
+  base::ClaimGroup group;
+  auto *shared = group.AddPart();
+  size_t inside = 0, max_inside = 0, total = 0;
+  std::mutex inside_mu;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 3; ++t) {
+    threads.emplace_back([&] {
+      group.Join();
+      for (int i = 0; i < 1000; ++i) {
+        base::Claim claim(&group, shared);
+        {
+          std::lock_guard lock(inside_mu);
+          max_inside = std::max(max_inside, ++inside);
+        }
+        ++total;
+        std::lock_guard lock(inside_mu);
+        --inside;
+      }
+      group.Leave();
+    });
+  }
+  for (auto &t : threads) { t.join(); }
+  EXPECT(max_inside == size_t{1});
+  EXPECT(total == size_t{3000});
+}
+
+TEST(TakeNext) {
+  // Every part is taken exactly once, and a part taken stays claimed until
+  // its thread takes the next.
+  base::ClaimGroup group;
+  for (int i = 0; i < 50; ++i) { group.AddPart(); }
+  std::vector<int> times_taken(group.size());
+  std::mutex mu;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 3; ++t) {
+    threads.emplace_back([&] {
+      group.Join();
+      size_t i;
+      while ((i = group.TakeNext()) < group.size()) {
+        std::lock_guard lock(mu);
+        ++times_taken[i];
+      }
+      group.Leave();
+    });
+  }
+  for (auto &t : threads) { t.join(); }
+  EXPECT((times_taken == std::vector<int>(50, 1)));
+}
+
+TEST(Reentrant) {
+  base::ClaimGroup group;
+  auto *part = group.AddPart();
+  group.Join();
+  {
+    base::Claim outer(&group, part);
+    base::Claim inner(&group, part);
+    base::Claim all(&group, nullptr);
+    base::Claim all_again(&group, nullptr);
+  }
+  // Everything was released, so another thread may claim the part.
+  bool claimed = false;
+  std::thread other([&] {
+    group.Join();
+    base::Claim claim(&group, part);
+    claimed = true;
+    group.Leave();
+  });
+  other.join();
+  group.Leave();
+  EXPECT(claimed);
+}
+
+TEST(BorrowedInTwoThreadCycle) {
+  // Each thread holds the part it took and claims the other's. The thread
+  // which took the earlier part goes ahead, borrowing the other's part, while
+  // the other waits until the earlier part is released.
+  base::ClaimGroup group;
+  auto *part0 = group.AddPart();
+  auto *part1 = group.AddPart();
+  TakeInOrder order(&group);
+  Barrier barrier(2);
+  Log log;
+
+  std::thread t0([&] {
+    group.Join();
+    order.Take(0);
+    barrier.Arrive();
+    {
+      base::Claim claim(&group, part1);
+      log.Append(0);
+    }
+    group.Leave();
+  });
+  std::thread t1([&] {
+    group.Join();
+    order.Take(1);
+    barrier.Arrive();
+    {
+      base::Claim claim(&group, part0);
+      log.Append(1);
+    }
+    group.Leave();
+  });
+  t0.join();
+  t1.join();
+  EXPECT((log.entries() == std::vector<int>{0, 1}));
+}
+
+TEST(ThreeThreadCycle) {
+  // Thread i takes part i, then claims part i + 1 (mod 3), closing a cycle.
+  // Thread 0 took the earliest part, so it goes ahead. Once it leaves, part 0
+  // is free for thread 2, which leaves in turn, freeing part 2 for thread 1.
+  base::ClaimGroup group;
+  base::ClaimGroup::Part *parts[3];
+  for (auto &part : parts) { part = group.AddPart(); }
+  TakeInOrder order(&group);
+  Barrier barrier(3);
+  Log log;
+  size_t taken[3];
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < 3; ++i) {
+    threads.emplace_back([&, i] {
+      group.Join();
+      taken[i] = order.Take(i);
+      barrier.Arrive();
+      {
+        base::Claim claim(&group, parts[(i + 1) % 3]);
+        log.Append(static_cast<int>(i));
+      }
+      group.Leave();
+    });
+  }
+  for (auto &t : threads) { t.join(); }
+  EXPECT(taken[0] == size_t{0});
+  EXPECT(taken[1] == size_t{1});
+  EXPECT(taken[2] == size_t{2});
+  EXPECT((log.entries() == std::vector<int>{0, 2, 1}));
+}
+
+TEST(WholeStructure) {
+  // Claiming the whole structure waits until every other thread in the group
+  // is blocked or gone.
+  base::ClaimGroup group;
+  group.AddPart();
+  group.AddPart();
+  TakeInOrder order(&group);
+  Barrier barrier(2);
+  bool t0_done            = false;
+  bool t0_done_before_all = false;
+
+  std::thread t0([&] {
+    group.Join();
+    order.Take(0);
+    barrier.Arrive();
+    t0_done = true;
+    group.Leave();
+  });
+  std::thread t1([&] {
+    group.Join();
+    order.Take(1);
+    barrier.Arrive();
+    base::Claim claim(&group, nullptr);
+    t0_done_before_all = t0_done;
+    group.Leave();
+  });
+  t0.join();
+  t1.join();
+  EXPECT(t0_done_before_all);
+}
+
+TEST(WholeStructureClaimsParts) {
+  // Thread 0 blocks on the part thread 1 took, so thread 1 may claim the
+  // whole structure. It may then claim a part nobody holds. Claiming the part
+  // thread 0 holds closes a cycle, which thread 0 goes ahead through, having
+  // taken the earlier part. Thread 1 gets the part once thread 0 leaves.
+  base::ClaimGroup group;
+  auto *part0 = group.AddPart();
+  auto *part1 = group.AddPart();
+  auto *free  = group.AddPart();
+  TakeInOrder order(&group);
+  Barrier barrier(2);
+  Log log;
+
+  std::thread t0([&] {
+    group.Join();
+    order.Take(0);
+    barrier.Arrive();
+    {
+      base::Claim claim(&group, part1);
+      log.Append(0);
+    }
+    group.Leave();
+  });
+  std::thread t1([&] {
+    group.Join();
+    order.Take(1);
+    barrier.Arrive();
+    {
+      base::Claim all(&group, nullptr);
+      log.Append(1);
+      base::Claim free_claim(&group, free);
+      log.Append(2);
+      base::Claim claim(&group, part0);
+      log.Append(3);
+    }
+    group.Leave();
+  });
+  t0.join();
+  t1.join();
+  auto entries = log.entries();
+  // Thread 1 only gets the whole structure once thread 0 is blocked, and
+  // thread 0 is blocked until thread 1 claims part 0.
+  EXPECT((entries == std::vector<int>{1, 2, 0, 3}));
+}
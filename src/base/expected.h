@@ -1,8 +1,12 @@
-#include "base/debug.h"
+#ifndef ICARUS_BASE_EXPECTED_H
+#define ICARUS_BASE_EXPECTED_H
 
-#include <type_traits>
 #include <string>
 #include <string_view>
+#include <type_traits>
+#include <variant>
+
+#include "base/debug.h"
 
 namespace base {
 struct unexpected {
@@ -46,3 +50,5 @@ struct expected {
   std::variant<T, E> val_;
 };
 }  // namespace base
+
+#endif  // ICARUS_BASE_EXPECTED_H
@@ -1,8 +1,13 @@
 #ifndef ICARUS_BASE_GUARDED_H
 #define ICARUS_BASE_GUARDED_H
 
-#include <mutex>
+#include <cxxabi.h>
+#include <cstdlib>
 #include <memory>
+#include <mutex>
+#include <typeinfo>
+
+#include "base/trace.h"
 
 namespace base {
 template <typename T>
@@ -11,12 +16,28 @@ struct guarded {
   explicit guarded(Args&&... args) : val_(std::forward<Args>(args)...) {}
 
   auto lock() {
-    mu_.lock();
+    if (!trace::enabled) {
+      mu_.lock();
+    } else if (!mu_.try_lock()) {
+      // Only contended acquisitions are traced; the rest would be noise.
+      trace::Span span("lock", "wait for guarded<" + TypeName() + ">");
+      mu_.lock();
+    }
     auto deleter = [this](T*) { mu_.unlock(); };
     return std::unique_ptr<T, decltype(deleter)>(&val_, deleter);
   }
 
  private:
+  static std::string TypeName() {
+    int status = 0;
+    char *demangled =
+        abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status);
+    if (status != 0) { return typeid(T).name(); }
+    std::string result = demangled;
+    std::free(demangled);
+    return result;
+  }
+
   mutable std::mutex mu_;
   T val_;
 };
@@ -1,3 +1,6 @@
+#ifndef ICARUS_BASE_HASH_H
+#define ICARUS_BASE_HASH_H
+
 namespace base {
 namespace internal {
 struct hasher {
@@ -16,3 +19,5 @@ size_t hash_args(const Args &... args) {
   return (h << ... << args).value;
 }
 }  // namespace base
+
+#endif  // ICARUS_BASE_HASH_H
@@ -0,0 +1,82 @@
+#ifndef ICARUS_BASE_PERFECT_HASH_H
+#define ICARUS_BASE_PERFECT_HASH_H
+
+#include <array>
+#include <string_view>
+
+#include "base/types.h"
+
+namespace base {
+namespace internal {
+// Never defined. Reaching a call to this while evaluating a constant
+// expression makes that evaluation (and hence the build) fail.
+void NoPerfectHashSeedFound();
+}  // namespace internal
+
+// A lookup table for a fixed set of `N` distinct strings, built at compile
+// time. The hash function's seed is chosen so that no two of the strings land
+// in the same slot, so a lookup costs one hash and at most one comparison, and
+// never allocates.
+//
+// Usage:
+//   constexpr base::PerfectHash<3> kHash({"a", "b", "c"});
+//   static_assert(kHash.find("b") == 1);
+template <size_t N>
+struct PerfectHash {
+  constexpr explicit PerfectHash(std::array<std::string_view, N> const &words)
+      : words_(words) {
+    for (auto const &word : words_) {
+      if (word.size() > max_size_) { max_size_ = word.size(); }
+    }
+    for (seed_ = 0; seed_ < kMaxSeed; ++seed_) {
+      if (TryFill()) { return; }
+    }
+    internal::NoPerfectHashSeedFound();
+  }
+
+  // Returns the index of `s` in the array this table was built from, or -1 if
+  // it is not there.
+  constexpr int find(std::string_view s) const {
+    if (s.size() > max_size_) { return -1; }
+    i16 index = slots_[Slot(seed_, s)];
+    return (index >= 0 && words_[index] == s) ? index : -1;
+  }
+
+ private:
+  // Four slots for every string keeps the expected number of seeds we have to
+  // try small, so building the table doesn't noticeably slow compilation.
+  static constexpr size_t kNumSlots = [] {
+    size_t n = 1;
+    while (n < 4 * N) { n *= 2; }
+    return n;
+  }();
+  static constexpr u64 kMaxSeed = 1 << 16;
+
+  // FNV-1a, with the seed mixed into the offset basis.
+  static constexpr size_t Slot(u64 seed, std::string_view s) {
+    u64 h = 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+    for (char c : s) {
+      h ^= static_cast<u8>(c);
+      h *= 0x100000001b3ull;
+    }
+    return static_cast<size_t>((h ^ (h >> 32)) & (kNumSlots - 1));
+  }
+
+  constexpr bool TryFill() {
+    for (auto &slot : slots_) { slot = -1; }
+    for (size_t i = 0; i < N; ++i) {
+      auto &slot = slots_[Slot(seed_, words_[i])];
+      if (slot != -1) { return false; }
+      slot = static_cast<i16>(i);
+    }
+    return true;
+  }
+
+  std::array<std::string_view, N> words_;
+  std::array<i16, kNumSlots> slots_{};
+  size_t max_size_ = 0;
+  u64 seed_        = 0;
+};
+}  // namespace base
+
+#endif  // ICARUS_BASE_PERFECT_HASH_H
@@ -92,6 +92,11 @@ auto stringify(dispatch_rank<3>, const std::variant<Args...> &v)
   return std::visit([](auto &&v) { return stringify(v); }, v);
 }
 
+template <typename... Args>
+auto stringify(dispatch_rank<3>, std::variant<Args...> &v) -> std::string {
+  return std::visit([](auto &&v) { return stringify(v); }, v);
+}
+
 template <typename... Args>
 auto stringify(dispatch_rank<3>, std::variant<Args...> &&v) -> std::string {
   return std::visit([](auto &&v) { return stringify(v); }, v);
@@ -0,0 +1,114 @@
+#include "base/trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <vector>
+
+namespace base::trace {
+bool enabled = false;
+
+namespace {
+struct Event {
+  char const *category_;
+  std::string name_;
+  std::string detail_;
+  u64 start_;
+  u64 duration_;
+};
+
+struct ThreadBuffer {
+  explicit ThreadBuffer(u64 tid) : tid_(tid) {}
+
+  u64 tid_;
+  // Only ever contended while the trace is being written.
+  std::mutex mu_;
+  std::vector<Event> events_;
+};
+
+auto const trace_start = std::chrono::steady_clock::now();
+
+// Buffers outlive the threads which fill them, since modules are compiled on
+// short-lived threads.
+std::mutex buffers_mu;
+std::list<ThreadBuffer> buffers;
+
+ThreadBuffer &CurrentBuffer() {
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (buffer == nullptr) {
+    std::lock_guard lock(buffers_mu);
+    buffer = &buffers.emplace_back(buffers.size() + 1);
+  }
+  return *buffer;
+}
+}  // namespace
+
+u64 Now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - trace_start)
+      .count();
+}
+
+void Complete(char const *category, std::string name, u64 start,
+              std::string detail) {
+  if (!enabled) { return; }
+  u64 end      = Now();
+  auto &buffer = CurrentBuffer();
+  std::lock_guard lock(buffer.mu_);
+  buffer.events_.push_back(Event{category, std::move(name), std::move(detail),
+                                 start, end - start});
+}
+
+bool Write(char const *path) {
+  std::ofstream os(path);
+  if (!os) {
+    std::fprintf(stderr, "Failed to open \"%s\" for writing.\n", path);
+    return false;
+  }
+
+  os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  char const *sep = "\n";
+  std::lock_guard lock(buffers_mu);
+  for (auto &buffer : buffers) {
+    std::lock_guard buffer_lock(buffer.mu_);
+    for (auto const &event : buffer.events_) {
+      os << sep << "{\"name\": \"" << JsonEscape(event.name_)
+         << "\", \"cat\": \"" << event.category_
+         << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer.tid_
+         << ", \"ts\": " << event.start_ << ", \"dur\": " << event.duration_;
+      if (!event.detail_.empty()) {
+        os << ", \"args\": {\"detail\": \"" << JsonEscape(event.detail_)
+           << "\"}";
+      }
+      os << "}";
+      sep = ",\n";
+    }
+  }
+  os << "\n]}\n";
+  return static_cast<bool>(os);
+}
+
+std::string JsonEscape(std::string_view s) {
+  std::string result;
+  result.reserve(s.size());
+  for (char c : s) {
+    switch (c) {
+      case '"': result += "\\\""; break;
+      case '\\': result += "\\\\"; break;
+      case '\n': result += "\\n"; break;
+      case '\t': result += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+          result += buf;
+        } else {
+          result.push_back(c);
+        }
+    }
+  }
+  return result;
+}
+}  // namespace base::trace
@@ -0,0 +1,56 @@
+#ifndef ICARUS_BASE_TRACE_H
+#define ICARUS_BASE_TRACE_H
+
+#include <string>
+#include <string_view>
+
+#include "base/types.h"
+
+// Records spans of time in the Chrome trace-event format, so that a trace
+// viewer (chrome://tracing or Perfetto) can show how work on each thread
+// overlaps. Each thread appends to its own buffer, so recording does not
+// contend on a lock. When tracing is disabled, every entry point reduces to a
+// single branch.
+namespace base::trace {
+// Must be set before any thread which may record spans is started.
+extern bool enabled;
+
+// Microseconds since tracing began.
+u64 Now();
+
+// Records a span on the calling thread which began at `start` (as returned by
+// `Now`) and ends now. `category` must have static storage duration.
+void Complete(char const *category, std::string name, u64 start,
+              std::string detail = "");
+
+// Records a span covering its own lifetime.
+struct Span {
+  Span(char const *category, std::string name)
+      : category_(category), start_(enabled ? Now() : 0) {
+    if (enabled) { name_ = std::move(name); }
+  }
+  ~Span() {
+    if (enabled) {
+      Complete(category_, std::move(name_), start_, std::move(detail_));
+    }
+  }
+
+  // Attaches more information to the span, shown alongside it in the viewer.
+  void set_detail(std::string detail) { detail_ = std::move(detail); }
+
+ private:
+  char const *category_;
+  u64 start_;
+  std::string name_;
+  std::string detail_;
+};
+
+// Writes every span recorded so far, on all threads, to `path`. Returns false
+// if the file could not be written.
+bool Write(char const *path);
+
+// Escapes `s` for inclusion in a JSON string literal.
+std::string JsonEscape(std::string_view s);
+}  // namespace base::trace
+
+#endif  // ICARUS_BASE_TRACE_H
@@ -76,6 +76,12 @@ struct untyped_buffer {
     size_ = new_size;
   }
 
+  // Shrinks the buffer to `n` bytes, keeping its capacity.
+  void truncate(size_t n) {
+    ASSERT(n <= size_);
+    size_ = n;
+  }
+
   void pad_to(size_t n) {
     size_t new_size = std::max(n, size_);
     if (new_size > capacity_) { reallocate(new_size); }
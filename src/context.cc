@@ -8,10 +8,9 @@ type::Type const *Context::type_of(ast::Expression const *expr) const {
   // When searching in embedded modules we intentionally look with no bound
   // constants. Across module boundaries, a declaration can't be present anyway.
   for (Module const *mod : mod_->global_->embedded_modules_) {
-    auto bc_iter = mod->data_.find(ast::BoundConstants{});
-    if (bc_iter == mod->data_.end()) { continue; }
-    auto iter = bc_iter->second.types_.data_.find(expr);
-    if (iter != bc_iter->second.types_.data_.end()) { return iter->second; }
+    if (auto *result = mod->type_of(ast::BoundConstants{}, expr)) {
+      return result;
+    }
   }
   return nullptr;
 }
@@ -22,38 +21,44 @@ type::Type const *Context::set_type(ast::Expression const *expr,
 }
 
 void Context::set_addr(ast::Declaration *decl, ir::Register r) {
-  mod_->data_[bound_constants_].addr_[decl] = r;
+  auto lock = mod_->LockData();
+  mod_->data(bound_constants_).addr_[decl] = r;
 }
 
 ir::Register Context::addr(ast::Declaration *decl) const {
   return mod_->addr(bound_constants_, decl);
 }
 
-void Context::set_dispatch_table(ast::Expression const *expr,
-                                 ast::DispatchTable &&table) {
-  ASSERT(mod_->data_[bound_constants_]
+void Context::set_dispatch_table(
+    ast::Expression const *expr,
+    std::shared_ptr<ast::DispatchTable const> table) {
+  auto lock = mod_->LockData();
+  ASSERT(mod_->data(bound_constants_)
              .dispatch_tables_.emplace(expr, std::move(table))
              .second);
 }
 
 ast::DispatchTable const *Context::dispatch_table(ast::Expression const *expr) const {
-  auto &table = mod_->data_[bound_constants_].dispatch_tables_;
+  auto lock = mod_->LockData();
+  auto &table = mod_->data(bound_constants_).dispatch_tables_;
   if (auto iter = table.find(expr); iter != table.end()) {
-    return &iter->second;
+    return iter->second.get();
   }
   if (parent_) { return parent_->dispatch_table(expr); }
   return nullptr;
 }
 
-void Context::push_rep_dispatch_table(ast::Node const *node,
-                                      ast::DispatchTable &&tables) {
-  mod_->data_[bound_constants_].repeated_dispatch_tables_[node].push_back(
-      std::move(tables));
+void Context::push_rep_dispatch_table(
+    ast::Node const *node, std::shared_ptr<ast::DispatchTable const> table) {
+  auto lock = mod_->LockData();
+  mod_->data(bound_constants_).repeated_dispatch_tables_[node].push_back(
+      std::move(table));
 }
 
-base::vector<ast::DispatchTable> const *Context::rep_dispatch_tables(
-    ast::Node const *node) const {
-  auto &table = mod_->data_[bound_constants_].repeated_dispatch_tables_;
+base::vector<std::shared_ptr<ast::DispatchTable const>> const *
+Context::rep_dispatch_tables(ast::Node const *node) const {
+  auto lock = mod_->LockData();
+  auto &table = mod_->data(bound_constants_).repeated_dispatch_tables_;
   if (auto iter = table.find(node); iter != table.end()) {
     return &iter->second;
   }
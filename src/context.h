@@ -24,23 +24,25 @@ struct Context {
   Context(Module *mod) : mod_(ASSERT_NOT_NULL(mod)) {}
 
   size_t num_errors() { return error_log_.size(); }
-  void DumpErrors() { error_log_.Dump(); }
+  void DumpErrors() {
+    if (!defer_dump_) { error_log_.Dump(); }
+  }
 
   type::Type const *type_of(ast::Expression const *expr) const;
   type::Type const *set_type(ast::Expression const *expr, type::Type const *t);
 
   ast::DispatchTable const *dispatch_table(ast::Expression const *expr) const;
   void set_dispatch_table(ast::Expression const *expr,
-                          ast::DispatchTable &&table);
+                          std::shared_ptr<ast::DispatchTable const> table);
   ast::DispatchTable const *dispatch_table(ast::Node const *node, size_t index) const;
   void push_dispatch_table(ast::Node const *node,
                            ast::DispatchTable &&table);
 
-  base::vector<ast::DispatchTable> const *rep_dispatch_tables(
-      ast::Node const *node) const;
+  base::vector<std::shared_ptr<ast::DispatchTable const>> const *
+  rep_dispatch_tables(ast::Node const *node) const;
 
   void push_rep_dispatch_table(ast::Node const *node,
-                               ast::DispatchTable &&tables);
+                               std::shared_ptr<ast::DispatchTable const> table);
 
   ir::Register addr(ast::Declaration *decl) const;
   void set_addr(ast::Declaration *decl, ir::Register);
@@ -51,6 +53,10 @@ struct Context {
 
   ast::BoundConstants bound_constants_;
 
+  // Set when the errors logged here are later appended to another context's
+  // log, to be dumped from there.
+  bool defer_dump_ = false;
+
   // TODO this looks useful in bindings too. maybe give it a better name and
   // use it more frequently?
   struct YieldResult {
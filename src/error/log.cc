@@ -31,13 +31,13 @@ inline size_t NumDigits(size_t n) {
   return counter;
 }
 
-std::string LineToDisplay(size_t line_num, const frontend::Source::Line &line,
+std::string LineToDisplay(size_t line_num, std::string_view line,
                           size_t border_alignment = 0) {
   auto num_digits = NumDigits(line_num);
   if (border_alignment == 0) { border_alignment = num_digits; }
   ASSERT(border_alignment >= num_digits);
   return std::string(border_alignment - num_digits, ' ') +
-         std::to_string(line_num) + "| " + line + "\n";
+         std::to_string(line_num) + "| " + std::string(line) + "\n";
 }
 
 struct DisplayAttrs {
@@ -70,14 +70,13 @@ void WriteSource(
     size_t line_num = line_intervals.endpoints_[i];
     size_t end_num  = line_intervals.endpoints_[i + 1];
     while (line_num < end_num) {
-      const auto &line = source.lines.at(line_num);
 
       // Line number
       os << "\033[97;1m" << std::right
          << std::setw(static_cast<int>(border_alignment)) << line_num
          << " | \033[0m";
 
-      std::string_view line_view(line);
+      std::string_view line_view = source.line(line_num);
       iter = std::lower_bound(iter, underlines.end(), line_num,
                               [](const auto &span_and_attrs, size_t n) {
                                 return span_and_attrs.first.start.line_num < n;
@@ -113,7 +112,7 @@ void WriteSource(
       if (end_num + 1 == line_intervals.endpoints_[i + 2]) {
         os << "\033[97;1m" << std::right
            << std::setw(static_cast<int>(border_alignment)) << line_num << " | "
-           << "\033[0m" << source.lines.at(end_num) << "\n";
+           << "\033[0m" << source.line(end_num) << "\n";
       } else {
         os << "\033[97;1m" << std::right
            << std::setw(static_cast<int>(border_alignment) + 3)
@@ -125,7 +124,7 @@ void WriteSource(
 }  // namespace
 namespace error {
 void Log::UndeclaredIdentifier(ast::Identifier *id) {
-  undeclared_ids_[id->token].push_back(id);
+  undeclared_ids_[std::string(id->token.get())].push_back(id);
 }
 
 void Log::PostconditionNeedsBool(TextSpan const &span, type::Type const *t) {
@@ -410,11 +409,38 @@ void Log::CyclicDependency(base::vector<ast::Identifier const *> cyc_deps) {
   cyc_dep_vecs_.push_back(std::move(cyc_deps));
 }
 
+void Log::CyclicImport(
+    TextSpan const &span,
+    base::vector<std::filesystem::path const *> const &cycle) {
+  std::stringstream ss;
+  ss << "Found a cyclic import:\n\n";
+  for (size_t i = 0; i < cycle.size(); ++i) {
+    ss << (i == 0 ? "    " : "  imports ") << cycle[i]->string() << "\n";
+  }
+  ss << "\n";
+  WriteSource(
+      ss, *span.source, {span.lines()},
+      {{span, DisplayAttrs{DisplayAttrs::RED, DisplayAttrs::UNDERLINE}}});
+  ss << "\n\n";
+  errors_.push_back(ss.str());
+}
+
+void Log::MissingImport(TextSpan const &span,
+                        std::filesystem::path const &src) {
+  std::stringstream ss;
+  ss << "No such import \"" << src.string() << "\".\n\n";
+  WriteSource(
+      ss, *span.source, {span.lines()},
+      {{span, DisplayAttrs{DisplayAttrs::RED, DisplayAttrs::UNDERLINE}}});
+  ss << "\n\n";
+  errors_.push_back(ss.str());
+}
+
 void Log::ShadowingDeclaration(ast::Declaration const &decl1,
                                ast::Declaration const &decl2) {
   // TODO migrate away from old display.
-  auto line1     = decl1.span.source->lines.at(decl1.span.start.line_num);
-  auto line2     = decl2.span.source->lines.at(decl2.span.start.line_num);
+  auto line1     = decl1.span.source->line(decl1.span.start.line_num);
+  auto line2     = decl2.span.source->line(decl2.span.start.line_num);
   auto line_num1 = decl1.span.start.line_num;
   auto line_num2 = decl2.span.start.line_num;
   auto align =
@@ -428,6 +454,21 @@ void Log::UserDefinedError(std::string const &err) {
   errors_.push_back(err + "\n\n");
 }
 
+void Log::Append(Log &&log) {
+  for (auto & [ token, ids ] : log.undeclared_ids_) {
+    auto &all_ids = undeclared_ids_[token];
+    all_ids.insert(all_ids.end(), ids.begin(), ids.end());
+  }
+  for (auto & [ decl, ids ] : log.out_of_order_decls_) {
+    auto &all_ids = out_of_order_decls_[decl];
+    all_ids.insert(all_ids.end(), ids.begin(), ids.end());
+  }
+  for (auto &cycle : log.cyc_dep_vecs_) {
+    cyc_dep_vecs_.push_back(std::move(cycle));
+  }
+  for (auto &err : log.errors_) { errors_.push_back(std::move(err)); }
+}
+
 void Log::Dump() const {
   for (auto& cycle : cyc_dep_vecs_) {
     // TODO make cyc_dep_vec just identifiers
@@ -445,7 +486,8 @@ void Log::Dump() const {
       // with the same color
 
       TextSpan decl_id_span = id->decl->span;
-      decl_id_span.finish.offset = decl_id_span.start.offset + id->token.size();
+      decl_id_span.finish.offset =
+          decl_id_span.start.offset + id->token.get().size();
       underlines.emplace_back(
           decl_id_span,
           DisplayAttrs{static_cast<DisplayAttrs::Color>(
@@ -1,6 +1,7 @@
 #ifndef ICARUS_ERROR_LOG_H
 #define ICARUS_ERROR_LOG_H
 
+#include <filesystem>
 #include <set>
 #include <string>
 
@@ -78,6 +79,10 @@ struct Log {
   void ComparingIncomparables(type::Type const *lhs, type::Type const *rhs,
                               TextSpan const &span);
   void CyclicDependency(base::vector<ast::Identifier const *> cyc_deps);
+  void CyclicImport(
+      TextSpan const &span,
+      base::vector<std::filesystem::path const *> const &cycle);
+  void MissingImport(TextSpan const &span, std::filesystem::path const &src);
 
   void MismatchedAssignmentSize(TextSpan const &span, size_t lhs, size_t rhs);
 
@@ -98,6 +103,9 @@ struct Log {
 
   void StatementsFollowingJump(TextSpan const &span);
 
+  // Appends everything logged in `log`, as though it had been logged here.
+  void Append(Log &&log);
+
   size_t size() const {
     return undeclared_ids_.size() + out_of_order_decls_.size() +
            errors_.size() + cyc_dep_vecs_.size();
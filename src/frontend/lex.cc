@@ -1,11 +1,13 @@
+#include <algorithm>
 #include <cmath>
-#include "base/container/unordered_map.h"
+#include "base/perfect_hash.h"
 
 #include "ast/hole.h"
 #include "ast/identifier.h"
 #include "ast/terminal.h"
 #include "error/log.h"
 #include "frontend/numbers.h"
+#include "frontend/scan.h"
 #include "frontend/tagged_node.h"
 #include "frontend/text_span.h"
 #include "frontend/token.h"
@@ -54,111 +56,181 @@ constexpr inline bool IsAlphaNumericOrUnderscore(char c) {
 
 TextSpan NextSimpleWord(SourceLocation &loc) {
   auto span = loc.ToSpan();
-  while (IsAlphaNumericOrUnderscore(*loc)) { loc.Increment(); }
+  loc.MoveTo(SkipWordChars(loc.data()));
   span.finish = loc.cursor;
   return span;
 }
 
-TaggedNode NextWord(SourceLocation &loc) {
-  // Match [a-zA-Z_][a-zA-Z0-9_]*
-  // We have already matched the first character
-  auto span         = NextSimpleWord(loc);
-  std::string token = loc.line().substr(span.start.offset,
-                                        span.finish.offset - span.start.offset);
-
-  static base::unordered_map<std::string, ir::Val> Reserved{
-      {"bool", ir::Val(type::Bool)},
-      {"int8", ir::Val(type::Int8)},
-      {"int16", ir::Val(type::Int16)},
-      {"int32", ir::Val(type::Int32)},
-      {"int64", ir::Val(type::Int64)},
-      {"nat8", ir::Val(type::Nat8)},
-      {"nat16", ir::Val(type::Nat16)},
-      {"nat32", ir::Val(type::Nat32)},
-      {"nat64", ir::Val(type::Nat64)},
-      {"float32", ir::Val(type::Float32)},
-      {"float64", ir::Val(type::Float64)},
-      {"type", ir::Val(type::Type_)},
-      {"module", ir::Val(type::Module)},
-      {"true", ir::Val(true)},
-      {"false", ir::Val(false)},
-      {"null", ir::Val(nullptr)},
+// Every word which is not lexed as an identifier.
+enum class WordKind : u8 { Reserved, Keyword, Block, Scope };
+struct Word {
+  std::string_view text;
+  WordKind kind;
+  Tag tag;  // Only meaningful for keywords.
+};
+
+// Reserved words come first, in the same order as their values in
+// `ReservedValue`.
+constexpr Word kWords[] = {
+    {"bool", WordKind::Reserved, expr},
+    {"int8", WordKind::Reserved, expr},
+    {"int16", WordKind::Reserved, expr},
+    {"int32", WordKind::Reserved, expr},
+    {"int64", WordKind::Reserved, expr},
+    {"nat8", WordKind::Reserved, expr},
+    {"nat16", WordKind::Reserved, expr},
+    {"nat32", WordKind::Reserved, expr},
+    {"nat64", WordKind::Reserved, expr},
+    {"float32", WordKind::Reserved, expr},
+    {"float64", WordKind::Reserved, expr},
+    {"type", WordKind::Reserved, expr},
+    {"module", WordKind::Reserved, expr},
+    {"true", WordKind::Reserved, expr},
+    {"false", WordKind::Reserved, expr},
+    {"null", WordKind::Reserved, expr},
+    {"foreign", WordKind::Reserved, expr},
+    {"opaque", WordKind::Reserved, expr},
+    {"byte_view", WordKind::Reserved, expr},
+    {"bytes", WordKind::Reserved, expr},
+    {"alignment", WordKind::Reserved, expr},
+    {"exit", WordKind::Reserved, expr},
+    {"start", WordKind::Reserved, expr},
 #ifdef DBG
-      {"debug_ir", DebugIrFunc()},
+    {"debug_ir", WordKind::Reserved, expr},
 #endif  // DBG
-      {"foreign", ir::Val::BuiltinGeneric(ForeignFuncIndex)},
-      {"opaque", ir::Val::BuiltinGeneric(OpaqueFuncIndex)},
-      {"byte_view", ir::Val(type::ByteView)},
-      {"bytes", BytesFunc()},
-      {"alignment", AlignFunc()},
+
+    {"which", WordKind::Keyword, op_l},
+    {"print", WordKind::Keyword, op_l},
+    {"ensure", WordKind::Keyword, op_l},
+    {"needs", WordKind::Keyword, op_l},
+    {"import", WordKind::Keyword, op_l},
+    {"flags", WordKind::Keyword, kw_block_head},
+    {"enum", WordKind::Keyword, kw_block_head},
+    {"generate", WordKind::Keyword, op_l},
+    {"struct", WordKind::Keyword, kw_struct},
+    {"return", WordKind::Keyword, op_lt},
+    {"yield", WordKind::Keyword, op_lt},
+    {"switch", WordKind::Keyword, kw_block_head},
+    {"when", WordKind::Keyword, op_b},
+    {"as", WordKind::Keyword, op_b},
+    {"interface", WordKind::Keyword, kw_block},
+    {"copy", WordKind::Keyword, op_l},
+    {"move", WordKind::Keyword, op_l},
+
+    {"block", WordKind::Block, kw_block},
+    {"scope", WordKind::Scope, kw_block},
+};
+constexpr size_t kNumWords = sizeof(kWords) / sizeof(kWords[0]);
+
+constexpr base::PerfectHash<kNumWords> kWordHash([] {
+  std::array<std::string_view, kNumWords> texts{};
+  for (size_t i = 0; i < kNumWords; ++i) { texts[i] = kWords[i].text; }
+  return texts;
+}());
+
+ir::Val const &ReservedValue(size_t index) {
+  static ir::Val const kValues[] = {
+      ir::Val(type::Bool),
+      ir::Val(type::Int8),
+      ir::Val(type::Int16),
+      ir::Val(type::Int32),
+      ir::Val(type::Int64),
+      ir::Val(type::Nat8),
+      ir::Val(type::Nat16),
+      ir::Val(type::Nat32),
+      ir::Val(type::Nat64),
+      ir::Val(type::Float32),
+      ir::Val(type::Float64),
+      ir::Val(type::Type_),
+      ir::Val(type::Module),
+      ir::Val(true),
+      ir::Val(false),
+      ir::Val(nullptr),
+      ir::Val::BuiltinGeneric(ForeignFuncIndex),
+      ir::Val::BuiltinGeneric(OpaqueFuncIndex),
+      ir::Val(type::ByteView),
+      BytesFunc(),
+      AlignFunc(),
       // TODO these are terrible. Make them reasonable. In particular, this is
       // definitively UB.
-      {"exit", ir::Val::Block(nullptr)},
-      {"start", ir::Val::Block(reinterpret_cast<ast::BlockLiteral *>(0x1))}};
-  if (auto iter = Reserved.find(token); iter != Reserved.end()) {
-    return TaggedNode::TerminalExpression(span, iter->second);
-  }
+      ir::Val::Block(nullptr),
+      ir::Val::Block(reinterpret_cast<ast::BlockLiteral *>(0x1)),
+#ifdef DBG
+      DebugIrFunc(),
+#endif  // DBG
+  };
+  ASSERT(kWords[index].kind == WordKind::Reserved);
+  return kValues[index];
+}
 
-  static const base::unordered_map<std::string, Tag> KeywordMap = {
-      {"which", op_l},         {"print", op_l},    {"ensure", op_l},
-      {"needs", op_l},         {"import", op_l},   {"flags", kw_block_head},
-      {"enum", kw_block_head}, {"generate", op_l}, {"struct", kw_struct},
-      {"return", op_lt},       {"yield", op_lt},   {"switch", kw_block_head},
-      {"when", op_b},          {"as", op_b},       {"interface", kw_block},
-      {"copy", op_l},          {"move", op_l}};
-  if (auto iter = KeywordMap.find(token); iter != KeywordMap.end()) {
-    return TaggedNode(span, iter->first, iter->second);
+TaggedNode NextWord(SourceLocation &loc) {
+  // Match [a-zA-Z_][a-zA-Z0-9_]*
+  // We have already matched the first character
+  auto span = NextSimpleWord(loc);
+  std::string_view token =
+      loc.line().substr(span.start.offset,
+                        span.finish.offset - span.start.offset);
+
+  int index = kWordHash.find(token);
+  if (index < 0) {
+    return TaggedNode(
+        std::make_unique<ast::Identifier>(span, Symbol(token)), expr);
   }
 
-  // "block" is special because it is also the name of the type of such a block.
-  // That is, `block { ... }` has type `block`. This means that a function
-  // returning a block will look like `() -> block { ... }` and there is an
-  // ambiguity whereby we can't tell if this should be parsed as
-  // A: () -> (block { ... }), or
-  // B: (() -> block) { ... }
-  //
-  // We can fix this in the parser easily (by checking for a `->` beforehand
-  // and prefering (B). Users can specifically add parentheses to get (A), but
-  // this requires tagging "block" differently from the other block-head
-  // keywords.
-  if (token == "block") {
-    auto t = type::Block;
-    if (*loc == '?') {
-      loc.Increment();
-      span.finish = loc.cursor;
-      t           = type::OptBlock;
-      token       = "block?";
-    } else if (*loc == '~') {
-      loc.Increment();
-      span.finish = loc.cursor;
-      t           = type::RepBlock;
-      token       = "block~";
-    }
-    return TaggedNode(std::make_unique<ast::Terminal>(span, ir::Val(t)),
-                      kw_block);
-  } else if (token == "scope") {
-    if (*loc == '!') {
-      loc.Increment();
-      span.finish = loc.cursor;
-      token = "scope!";
+  auto const &word = kWords[index];
+  switch (word.kind) {
+    case WordKind::Reserved:
+      return TaggedNode::TerminalExpression(span, ReservedValue(index));
+    case WordKind::Keyword:
+      return TaggedNode(span, std::string(word.text), word.tag);
+    case WordKind::Block: {
+      // "block" is special because it is also the name of the type of such a
+      // block. That is, `block { ... }` has type `block`. This means that a
+      // function returning a block will look like `() -> block { ... }` and
+      // there is an ambiguity whereby we can't tell if this should be parsed
+      // as
+      // A: () -> (block { ... }), or
+      // B: (() -> block) { ... }
+      //
+      // We can fix this in the parser easily (by checking for a `->`
+      // beforehand and prefering (B). Users can specifically add parentheses
+      // to get (A), but this requires tagging "block" differently from the
+      // other block-head keywords.
+      auto t = type::Block;
+      if (*loc == '?') {
+        loc.Increment();
+        span.finish = loc.cursor;
+        t           = type::OptBlock;
+      } else if (*loc == '~') {
+        loc.Increment();
+        span.finish = loc.cursor;
+        t           = type::RepBlock;
+      }
+      return TaggedNode(std::make_unique<ast::Terminal>(span, ir::Val(t)),
+                        kw_block);
     }
-    return TaggedNode(span, token, kw_block);
+    case WordKind::Scope:
+      if (*loc == '!') {
+        loc.Increment();
+        span.finish = loc.cursor;
+        return TaggedNode(span, "scope!", kw_block);
+      }
+      return TaggedNode(span, "scope", kw_block);
   }
-
-
-  return TaggedNode(std::make_unique<ast::Identifier>(span, token), expr);
+  UNREACHABLE();
 }
 
 TaggedNode NextNumber(SourceLocation &loc, error::Log *error_log) {
-  auto span         = loc.ToSpan();
-  const char *start = &*loc;
-  while (*loc == 'b' || *loc == 'o' || *loc == 'd' || *loc == 'x' ||
-         *loc == '_' || *loc == '.' || IsDigit(*loc)) {
-    loc.Increment();
-  }
+  auto span = loc.ToSpan();
+  size_t length;
+  auto number = ParseNumber(
+      std::string_view(loc.data(), loc.line().size() - loc.cursor.offset),
+      &length);
+  loc.MoveTo(loc.data() + length);
   span.finish = loc.cursor;
   return TaggedNode::TerminalExpression(
       span, std::visit(base::overloaded{[](i32 n) { return ir::Val(n); },
+                                        [](i64 n) { return ir::Val(n); },
                                         [](double d) { return ir::Val(d); },
                                         [&](std::string_view err) {
                                           error_log->InvalidNumber(span, err);
@@ -166,43 +238,52 @@ TaggedNode NextNumber(SourceLocation &loc, error::Log *error_log) {
                                           // guessing the type?
                                           return ir::Val(0);
                                         }},
-                       ParseNumber(std::string_view(start, &*loc - start))));
+                       number));
 }
 
 TaggedNode NextStringLiteral(SourceLocation &loc, error::Log *error_log) {
   auto span = loc.ToSpan();
   loc.Increment();
 
-  // TODO we assign to this repeatedly which is untenable perf-wise in the
-  // long-run.
-  std::string str_lit = "";
+  // Most literals have no escapes, in which case the literal is exactly the
+  // source text and can be interned without copying it first.
+  char const *start   = loc.data();
+  char const *run_end = FindStringLiteralSpecial(start);
+  loc.MoveTo(run_end);
+  std::string_view str_lit(start, run_end - start);
 
-  for (; *loc != '"' && *loc != '\0'; loc.Increment()) {
-    if (*loc != '\\') {
-      str_lit += *loc;
-      continue;
-    }
+  if (*loc == '\\') {
+    // Decoded here, then interned once it is complete.
+    std::string decoded(start, run_end);
 
-    loc.Increment();  // Iterate past '\\'
-    span.finish = loc.cursor;
-    switch (*loc) {
-      case '\\': str_lit += '\\'; break;
-      case '"': str_lit += '"'; break;
-      case 'a': str_lit += '\a'; break;
-      case 'b': str_lit += '\b'; break;
-      case 'f': str_lit += '\f'; break;
-      case 'n': str_lit += '\n'; break;
-      case 'r': str_lit += '\r'; break;
-      case 't': str_lit += '\t'; break;
-      case 'v': str_lit += '\v'; break;
-      default:
-        TextSpan invalid = loc.ToSpan();
-        --invalid.start.offset;
-        ++invalid.finish.offset;
-        error_log->InvalidEscapedCharacterInStringLiteral(invalid);
-        str_lit += *loc;
-        break;
+    while (*loc == '\\') {
+      loc.Increment();  // Iterate past '\\'
+      span.finish = loc.cursor;
+      switch (*loc) {
+        case '\\': decoded += '\\'; break;
+        case '"': decoded += '"'; break;
+        case 'a': decoded += '\a'; break;
+        case 'b': decoded += '\b'; break;
+        case 'f': decoded += '\f'; break;
+        case 'n': decoded += '\n'; break;
+        case 'r': decoded += '\r'; break;
+        case 't': decoded += '\t'; break;
+        case 'v': decoded += '\v'; break;
+        default:
+          TextSpan invalid = loc.ToSpan();
+          --invalid.start.offset;
+          ++invalid.finish.offset;
+          error_log->InvalidEscapedCharacterInStringLiteral(invalid);
+          decoded += *loc;
+          break;
+      }
+      loc.Increment();
+
+      run_end = FindStringLiteralSpecial(loc.data());
+      decoded.append(loc.data(), run_end);
+      loc.MoveTo(run_end);
     }
+    str_lit = decoded;
   }
 
   if (*loc == '\n' || *loc == '\0') {
@@ -230,8 +311,8 @@ TaggedNode NextHashtag(SourceLocation &loc, error::Log *error_log) {
   } else {
     span = NextSimpleWord(loc);
   }
-  std::string token = loc.line().substr(span.start.offset,
-                                        span.finish.offset - span.start.offset);
+  std::string token(loc.line().substr(span.start.offset,
+                                      span.finish.offset - span.start.offset));
   auto t            = TaggedNode(span, token, hashtag);
   return t;
 }
@@ -539,7 +620,7 @@ TaggedNode NextSlashInitiatedToken(SourceLocation &loc, error::Log *error_log) {
 
       u64 comment_layer = 1;
       while (comment_layer != 0) {
-        if (loc.source->seen_eof) {
+        if (loc.seen_eof) {
           error_log->RunawayMultilineComment();
           span.finish = loc.cursor;
           return TaggedNode(span, "", eof);
@@ -553,6 +634,15 @@ TaggedNode NextSlashInitiatedToken(SourceLocation &loc, error::Log *error_log) {
 
         back_one = *loc;
         loc.Increment();
+
+        if (comment_layer == 0) { break; }
+        // Only '*' and '/' can open or close a comment, so skip ahead to the
+        // next one on this line.
+        char const *next = FindCommentDelimiter(loc.data());
+        if (next != loc.data()) {
+          back_one = next[-1];
+          loc.MoveTo(next);
+        }
       }
       return TaggedNode::Invalid();
     }
@@ -568,7 +658,7 @@ TaggedNode NextSlashInitiatedToken(SourceLocation &loc, error::Log *error_log) {
 TaggedNode NextToken(SourceLocation &loc, error::Log *error_log) {
 restart:
   // Delegate based on the next character in the file stream
-  if (loc.source->seen_eof) {
+  if (loc.seen_eof) {
     return TaggedNode(loc.ToSpan(), "", eof);
   } else if (IsAlphaOrUnderscore(*loc)) {
     return NextWord(loc);
@@ -587,7 +677,7 @@ restart:
     case '/': tagged_node = NextSlashInitiatedToken(loc, error_log); break;
     case '\t':
     case ' ':
-      loc.Increment();
+      loc.MoveTo(SkipBlanks(loc.data()));
       goto restart;  // Skip whitespace
     case '\n':
     case '\0': loc.Increment(); return TaggedNode(loc.ToSpan(), "", newline);
@@ -596,4 +686,69 @@ restart:
   if (!tagged_node.valid()) { goto restart; }
   return tagged_node;
 }
+
+bool SkipFunctionBody(SourceLocation &loc, TextSpan *body) {
+  u32 last_line_num = std::min(
+      loc.end.line_num, static_cast<u32>(loc.source->last_line_num()));
+  u32 line_num          = loc.cursor.line_num;
+  std::string_view line = loc.source->line(line_num);
+
+  // Only bodies whose opening brace ends its line and whose closing brace
+  // starts its line are skipped, so that they can be parsed later as a run of
+  // whole lines.
+  size_t rest = line.find_first_not_of(" \t", loc.cursor.offset);
+  if (rest != std::string_view::npos && line.substr(rest, 2) != "//") {
+    return false;
+  }
+
+  int brace_depth   = 1;
+  int comment_depth = 0;
+  while (line_num < last_line_num) {
+    line = loc.source->line(++line_num);
+    for (size_t i = 0; i < line.size(); ++i) {
+      char next = (i + 1 < line.size()) ? line[i + 1] : '\0';
+      if (comment_depth > 0) {
+        if (line[i] == '*' && next == '/') {
+          --comment_depth;
+          ++i;
+        } else if (line[i] == '/' && next == '*') {
+          ++comment_depth;
+          ++i;
+        }
+        continue;
+      }
+
+      switch (line[i]) {
+        case '"':
+          for (++i; i < line.size() && line[i] != '"'; ++i) {
+            if (line[i] == '\\') { ++i; }
+          }
+          // Leave runaway string literals for the lexer to report.
+          if (i >= line.size()) { return false; }
+          break;
+        case '/':
+          if (next == '/') {
+            i = line.size();
+          } else if (next == '*') {
+            ++comment_depth;
+            ++i;
+          }
+          break;
+        case '{': ++brace_depth; break;
+        case '}':
+          if (--brace_depth != 0) { break; }
+          if (line.find_first_not_of(" \t") != i) { return false; }
+          body->start  = loc.cursor;
+          body->finish = Cursor{static_cast<u32>(i), line_num};
+          body->source = loc.source;
+          loc.cursor   = Cursor{static_cast<u32>(i + 1), line_num};
+          if (line_num == loc.end.line_num && i + 1 >= loc.end.offset) {
+            loc.seen_eof = true;
+          }
+          return true;
+      }
+    }
+  }
+  return false;
+}
 }  // namespace frontend
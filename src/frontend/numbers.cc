@@ -1,132 +1,297 @@
 #include "frontend/numbers.h"
 
-#include <algorithm>
-#include "base/debug.h"
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
 
 namespace frontend {
 namespace {
-template <int Base>
-i32 DigitInBase(char c);
-template <>
-i32 DigitInBase<10>(char c) {
-  return ('0' <= c && c <= '9') ? (c - '0') : -1;
-}
-template <>
-i32 DigitInBase<2>(char c) {
-  return ((c | 1) == '1') ? (c - '0') : -1;
-}
-template <>
-i32 DigitInBase<8>(char c) {
-  return ((c | 7) == '7') ? (c - '0') : -1;
-}
-template <>
-i32 DigitInBase<16>(char c) {
-  int digit = DigitInBase<10>(c);
-  if (digit != -1) { return digit; }
-  if ('A' <= c && c <= 'F') { return c - 'A' + 10; }
+// Returns the value of `c` as a digit in any base up to 16, or -1 if it is not
+// one.
+i32 DigitValue(char c) {
+  if ('0' <= c && c <= '9') { return c - '0'; }
   if ('a' <= c && c <= 'f') { return c - 'a' + 10; }
+  if ('A' <= c && c <= 'F') { return c - 'A' + 10; }
   return -1;
 }
 
-template <int Base>
-bool IntRepresentableInBase(const std::string &s);
-
-template <>
-bool IntRepresentableInBase<2>(const std::string &s) {
-  return s.size() > 31;
+bool IsNumberChar(char c, int base) {
+  switch (c) {
+    case '_':
+    case '.':
+    case 'b':
+    case 'o':
+    case 'd':
+    case 'x': return true;
+    default:
+      return ('0' <= c && c <= '9') || (base == 16 && DigitValue(c) != -1);
+  }
 }
 
-template <>
-bool IntRepresentableInBase<8>(const std::string &s) {
-  return (s.size() > 11 || (s.size() == 11 && s[0] > '1'));
-}
+__extension__ typedef unsigned __int128 u128;
 
-template <>
-bool IntRepresentableInBase<10>(const std::string &s) {
-  return s.size() > 10 || (s.size() == 10 && s > "2147483647");
-}
+// Every integer up to 2^53 is exactly representable as a double, as is every
+// power of ten up to 10^22.
+constexpr u64 kMaxExactInteger = u64{1} << 53;
+constexpr double kExactPowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+constexpr i32 kMaxExactPowerOfTen = 22;
 
-template <>
-bool IntRepresentableInBase<16>(const std::string &s) {
-  return s.size() > 8 || (s.size() == 8 && s[0] > '7');
-}
+// An unsigned integer just wide enough to compute `kPowersOfTen` with.
+struct BigNum {
+  static constexpr int kLimbs = 40;
+
+  constexpr void MultiplyBy(u32 n) {
+    u64 carry = 0;
+    for (int i = 0; i < kLimbs; ++i) {
+      u64 x     = u64{limbs_[i]} * n + carry;
+      limbs_[i] = static_cast<u32>(x);
+      carry     = x >> 32;
+    }
+  }
 
-template <int Base>
-NumberOrError ParseIntInBase(const std::string &s) {
-  if (IntRepresentableInBase<Base>(s)) {
-    return "Number is too large to fit in a 32-bit signed integer";
+  constexpr void DivideBy(u32 n) {
+    u64 remainder = 0;
+    for (int i = kLimbs - 1; i >= 0; --i) {
+      u64 x     = (remainder << 32) | limbs_[i];
+      limbs_[i] = static_cast<u32>(x / n);
+      remainder = x % n;
+    }
   }
-  i32 result = 0;
-  for (char c : s) {
-    i32 digit = DigitInBase<Base>(c);
-    if (digit == -1) { return "Number contains an invalid digit."; }
-    result = result * Base + digit;
+
+  // Returns the 128 most significant bits, high word first, shifted so that
+  // the top one is set.
+  constexpr std::array<u64, 2> Top128Bits() const {
+    int num_bits = kLimbs * 32;
+    while (num_bits > 0 && Bit(num_bits - 1) == 0) { --num_bits; }
+    u64 hi = 0;
+    u64 lo = 0;
+    for (int i = num_bits - 1; i >= num_bits - 128; --i) {
+      hi = (hi << 1) | (lo >> 63);
+      lo = (lo << 1) | (i >= 0 ? Bit(i) : 0);
+    }
+    return {hi, lo};
   }
-  return result;
-}
 
-template <int Base>
-NumberOrError ParseRealInBase(const std::string &s, int dot) {
-  i64 int_part = 0;
-  for (int i = 0; i < dot; ++i) {
-    i32 digit = DigitInBase<Base>(s[i]);
-    if (digit == -1) { return "Number contains an invalid digit."; }
-    int_part = int_part * Base + digit;
+  constexpr u64 Bit(int i) const { return (limbs_[i / 32] >> (i % 32)) & 1; }
+
+  u32 limbs_[kLimbs] = {};  // Least significant first.
+};
+
+// `kPowersOfTen[e - kMinPowerOfTen]` holds the 128 most significant bits of
+// 10^e, rounded down. A literal without any digits after `.` can't have an
+// exponent below -342 without underflowing to zero anyway.
+constexpr i32 kMinPowerOfTen = -342;
+constexpr i32 kMaxPowerOfTen = 308;
+constexpr auto kPowersOfTen  = [] {
+  std::array<std::array<u64, 2>, kMaxPowerOfTen - kMinPowerOfTen + 1> table{};
+  // Up to a power of two, 10^e is 5^e, so we need only the powers of five.
+  BigNum n;
+  n.limbs_[0] = 1;
+  for (i32 e = 0; e <= kMaxPowerOfTen; ++e) {
+    table[e - kMinPowerOfTen] = n.Top128Bits();
+    n.MultiplyBy(5);
   }
+  // 2^1216 / 5^342 still has well over 128 bits.
+  BigNum r;
+  r.limbs_[38] = 1;
+  for (i32 e = -1; e >= kMinPowerOfTen; --e) {
+    r.DivideBy(5);
+    table[e - kMinPowerOfTen] = r.Top128Bits();
+  }
+  return table;
+}();
 
-  i64 frac_part = 0;
-  i64 exp       = 1;
-  for (size_t i = dot + 1; i < s.size(); ++i) {
-    i32 digit = DigitInBase<Base>(s[i]);
-    if (digit == -1) { return "Number contains an invalid digit."; }
-    exp *= Base;
-    frac_part = frac_part * Base + digit;
+// The Eisel-Lemire algorithm: computes `mantissa * 10^exponent`, correctly
+// rounded, from a 128-bit approximation of the power of ten. Returns false
+// in the rare cases where the approximation is too close to call, or the
+// result is subnormal or infinite.
+bool EiselLemire(u64 mantissa, i32 exponent, double *result) {
+  if (mantissa == 0) {
+    *result = 0;
+    return true;
+  }
+  if (exponent < kMinPowerOfTen || exponent > kMaxPowerOfTen) { return false; }
+
+  int leading_zeros = __builtin_clzll(mantissa);
+  mantissa <<= leading_zeros;
+  // 217706 / 2^16 is just over log2(10).
+  u64 exp2 = static_cast<u64>(((217706 * exponent) >> 16) + 64 + 1023) -
+             static_cast<u64>(leading_zeros);
+
+  auto const & [ pow_hi, pow_lo ] = kPowersOfTen[exponent - kMinPowerOfTen];
+  u128 x    = static_cast<u128>(mantissa) * pow_hi;
+  u64 x_hi  = static_cast<u64>(x >> 64);
+  u64 x_lo  = static_cast<u64>(x);
+  if ((x_hi & 0x1ff) == 0x1ff && x_lo + mantissa < mantissa) {
+    // The low bits of the product might carry into the ones we keep, so we
+    // need the rest of the power of ten.
+    u128 y        = static_cast<u128>(mantissa) * pow_lo;
+    u64 y_hi      = static_cast<u64>(y >> 64);
+    u64 y_lo      = static_cast<u64>(y);
+    u64 merged_hi = x_hi;
+    u64 merged_lo = x_lo + y_hi;
+    if (merged_lo < x_lo) { ++merged_hi; }
+    if ((merged_hi & 0x1ff) == 0x1ff && merged_lo + 1 == 0 &&
+        y_lo + mantissa < mantissa) {
+      return false;
+    }
+    x_hi = merged_hi;
+    x_lo = merged_lo;
   }
-  return int_part + static_cast<double>(frac_part) / exp;
-}
 
-template <int Base>
-NumberOrError ParseNumberInBase(std::string_view sv) {
-  std::string copy(sv.data(), sv.size());
-  copy.erase(
-      std::remove_if(copy.begin(), copy.end(), [](char c) { return c == '_'; }),
-      copy.end());
+  // Keep 54 bits, so that we can round to 53.
+  u64 msb          = x_hi >> 63;
+  u64 result_bits  = x_hi >> (msb + 9);
+  exp2 -= 1 ^ msb;
+  if (x_lo == 0 && (x_hi & 0x1ff) == 0 && (result_bits & 3) == 1) {
+    // Exactly halfway between two doubles, as far as we can tell.
+    return false;
+  }
+  result_bits += result_bits & 1;
+  result_bits >>= 1;
+  if ((result_bits >> 53) > 0) {
+    result_bits >>= 1;
+    ++exp2;
+  }
+  if (exp2 - 1 >= 0x7ff - 1) { return false; }
+
+  result_bits = (exp2 << 52) | (result_bits & ((u64{1} << 52) - 1));
+  std::memcpy(result, &result_bits, sizeof(double));
+  return true;
+}
 
-  int first_dot   = -1;
-  size_t num_dots = 0;
-  for (size_t i = 0; i < copy.size(); ++i) {
-    if (copy[i] != '.') { continue; }
-    if (num_dots++ == 0) { first_dot = i; }
+// Returns `mantissa * 10^exponent`, where `digits` is the text of the literal
+// it was read from and `exact` is false if some nonzero digits did not fit in
+// `mantissa`. When the mantissa and the power of ten are both exact doubles, a
+// single multiplication or division rounds correctly, and that covers most
+// literals written by hand. Nearly everything else is handled by Eisel-Lemire,
+// and `strtod` (which is much slower but always rounds correctly) catches the
+// rest.
+double DecimalToDouble(u64 mantissa, i32 exponent, bool exact,
+                       std::string_view digits) {
+  if (exact && mantissa <= kMaxExactInteger &&
+      -kMaxExactPowerOfTen <= exponent && exponent <= kMaxExactPowerOfTen) {
+    double d = static_cast<double>(mantissa);
+    return exponent < 0 ? d / kExactPowersOfTen[-exponent]
+                        : d * kExactPowersOfTen[exponent];
   }
 
-  if (num_dots == copy.size()) {
-    // TODO better error message here
-    return "Need at least one digit in a number.";
+  double result;
+  if (EiselLemire(mantissa, exponent, &result)) {
+    // If digits were dropped, the true value lies strictly between
+    // `mantissa` and `mantissa + 1` (scaled), so if both round the same way,
+    // so does it.
+    double upper;
+    if (exact ||
+        (EiselLemire(mantissa + 1, exponent, &upper) && upper == result)) {
+      return result;
+    }
   }
 
-  switch (num_dots) {
-    case 0: return ParseIntInBase<Base>(copy);
-    case 1: return ParseRealInBase<Base>(copy, first_dot);
-    default: return "Too many `.` characters in numeric literal.";
+  std::string copy;
+  copy.reserve(digits.size());
+  for (char c : digits) {
+    if (c != '_') { copy.push_back(c); }
   }
-  UNREACHABLE();
+  return std::strtod(copy.c_str(), nullptr);
 }
 }  // namespace
 
-NumberOrError ParseNumber(std::string_view sv) {
-  if (sv.size() > 1 && sv[0] == '0') {
-    if (sv[1] == '.') { return ParseNumberInBase<10>(sv); }
-    char base = sv[1];
-    sv.remove_prefix(2);
-    switch (base) {
-      case 'b': return ParseNumberInBase<2>(sv);
-      case 'o': return ParseNumberInBase<8>(sv);
-      case 'd': return ParseNumberInBase<10>(sv);
-      case 'x': return ParseNumberInBase<16>(sv);
-      default: return "Base must be one of `b`, `o`, `d`, or `x`.";
+NumberOrError ParseNumber(std::string_view sv, size_t *length) {
+  char const *p   = sv.data();
+  char const *end = sv.data() + sv.size();
+
+  int base      = 10;
+  bool bad_base = false;
+  if (sv.size() > 1 && sv[0] == '0' && sv[1] != '.' &&
+      IsNumberChar(sv[1], base)) {
+    switch (sv[1]) {
+      case 'b': base = 2; break;
+      case 'o': base = 8; break;
+      case 'd': base = 10; break;
+      case 'x': base = 16; break;
+      default: bad_base = true; break;
+    }
+    p += 2;
+  }
+  char const *digits_start = p;
+
+  // The value of the literal is `mantissa * base^exponent`, up to any digits
+  // which did not fit in `mantissa`. Once one digit doesn't fit, none of the
+  // digits after it are accumulated either.
+  u64 mantissa       = 0;
+  i32 exponent       = 0;
+  bool overflowed    = false;
+  bool inexact       = false;  // Whether a nonzero digit did not fit.
+  bool any_digits    = false;
+  bool invalid_digit = false;
+  int num_dots       = 0;
+  // Any digit can be appended to a mantissa no larger than this.
+  u64 const max_mantissa = (std::numeric_limits<u64>::max() - 15) / base;
+  for (; p != end && IsNumberChar(*p, base); ++p) {
+    if (*p == '_') { continue; }
+    if (*p == '.') {
+      ++num_dots;
+      continue;
+    }
+
+    any_digits = true;
+    i32 digit  = DigitValue(*p);
+    if (digit < 0 || digit >= base) {
+      invalid_digit = true;
+      continue;
+    }
+
+    if (!overflowed && mantissa <= max_mantissa) {
+      mantissa = mantissa * base + digit;
+      if (num_dots != 0) { --exponent; }
+    } else {
+      overflowed = true;
+      inexact |= (digit != 0);
+      if (num_dots == 0) { ++exponent; }
     }
-  } else {
-    return ParseNumberInBase<10>(sv);
   }
+  *length = p - sv.data();
+
+  if (bad_base) { return "Base must be one of `b`, `o`, `d`, or `x`."; }
+  if (!any_digits) { return "Need at least one digit in a number."; }
+  if (num_dots > 1) { return "Too many `.` characters in numeric literal."; }
+  if (invalid_digit) { return "Number contains an invalid digit."; }
+
+  if (num_dots == 0) {
+    if (overflowed ||
+        mantissa > static_cast<u64>(std::numeric_limits<i64>::max())) {
+      return "Number is too large to fit in a 64-bit signed integer.";
+    }
+    if (mantissa <= static_cast<u64>(std::numeric_limits<i32>::max())) {
+      return static_cast<i32>(mantissa);
+    }
+    return static_cast<i64>(mantissa);
+  }
+
+  if (base == 10) {
+    return DecimalToDouble(mantissa, exponent, !inexact,
+                           std::string_view(digits_start, p - digits_start));
+  }
+
+  // Each digit is a whole number of bits, so the only rounding happens when
+  // the mantissa is converted to a double. Digits which didn't fit can only
+  // matter in breaking a tie, so a single low bit stands in for them.
+  int bits_per_digit = (base == 2) ? 1 : (base == 8) ? 3 : 4;
+  return std::ldexp(static_cast<double>(mantissa | (inexact ? 1 : 0)),
+                    exponent * bits_per_digit);
+}
+
+NumberOrError ParseNumber(std::string_view sv) {
+  size_t length;
+  auto result = ParseNumber(sv, &length);
+  if (length != sv.size()) { return "Number contains an invalid digit."; }
+  return result;
 }
 }  // namespace frontend
@@ -7,7 +7,19 @@
 #include "base/types.h"
 
 namespace frontend {
-using NumberOrError = std::variant<i32, double, std::string_view>;
+// Integer literals are `i32` when they fit and `i64` otherwise. Literals
+// containing a `.` are `double`s, rounded correctly to the nearest
+// representable value.
+using NumberOrError = std::variant<i32, i64, double, std::string_view>;
+
+// Parses the numeric literal at the start of `sv` in a single pass, and sets
+// `*length` to the number of characters it spans. A literal is a run of the
+// characters [0-9bodx_.] (along with [a-fA-F] after a `0x` prefix). Characters
+// in that run which are not digits in the literal's base make it invalid
+// rather than ending it.
+NumberOrError ParseNumber(std::string_view sv, size_t *length);
+
+// As above, but all of `sv` must be the literal.
 NumberOrError ParseNumber(std::string_view sv);
 }  // namespace frontend
 
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "frontend/numbers.h"
+
+using frontend::NumberOrError;
+using frontend::ParseNumber;
+
+namespace {
+// Literals shaped like the ones found in data tables: short integers, 64-bit
+// integers, and reals with a handful of fractional digits.
+std::vector<std::string> MakeLiterals(size_t n) {
+  std::mt19937_64 gen(0);
+  std::vector<std::string> literals;
+  literals.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    switch (i % 4) {
+      case 0: literals.push_back(std::to_string(gen() % 1000)); break;
+      case 1: literals.push_back(std::to_string(gen() >> 1)); break;
+      case 2: {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.6f",
+                      static_cast<double>(gen() % 100000000) / 997);
+        literals.push_back(buf);
+      } break;
+      case 3: {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.17g",
+                      static_cast<double>(gen() % 100000000) / 997);
+        literals.push_back(buf);
+      } break;
+    }
+  }
+  return literals;
+}
+
+template <typename Fn>
+void Run(char const *name, std::vector<std::string> const &literals, Fn fn) {
+  constexpr int kIterations = 20;
+  double checksum           = 0;
+  auto start                = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    for (auto const &literal : literals) { checksum += fn(literal); }
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::printf("%-12s %8.2f ns/literal (checksum %g)\n", name,
+              elapsed.count() / (kIterations * literals.size()), checksum);
+}
+
+double AsDouble(NumberOrError const &n) {
+  if (auto *i = std::get_if<i32>(&n)) { return *i; }
+  if (auto *i = std::get_if<i64>(&n)) { return static_cast<double>(*i); }
+  if (auto *d = std::get_if<double>(&n)) { return *d; }
+  std::abort();
+}
+}  // namespace
+
+int main() {
+  auto literals = MakeLiterals(100000);
+
+  // Every real must round exactly as `strtod` rounds it.
+  for (auto const &literal : literals) {
+    if (literal.find('.') == std::string::npos) { continue; }
+    if (AsDouble(ParseNumber(literal)) != std::strtod(literal.c_str(), nullptr)) {
+      std::printf("Mismatch on %s\n", literal.c_str());
+      return 1;
+    }
+  }
+
+  Run("ParseNumber", literals,
+      [](std::string const &s) { return AsDouble(ParseNumber(s)); });
+  Run("strtod", literals, [](std::string const &s) {
+    return std::strtod(s.c_str(), nullptr);
+  });
+  return 0;
+}
@@ -2,6 +2,7 @@
 
 #include "frontend/numbers.h"
 
+using frontend::ParseNumber;
 using test::Holds;
 
 TEST(Base2Integer) {
@@ -14,16 +15,21 @@ TEST(Base2Integer) {
   EXPECT(ParseNumber("0b__10"), Holds(2));
   EXPECT(ParseNumber("0b010"), Holds(2));
   EXPECT(ParseNumber("0b01____________________________________0"), Holds(2));
-  EXPECT(ParseNumber("0b00000000000000000000000000000000"),
-         Holds<std::string>());
+  EXPECT(ParseNumber("0b00000000000000000000000000000000"), Holds(0));
   EXPECT(ParseNumber("0b1111111111111111111111111111111"),
          Holds(std::numeric_limits<i32>::max()));
   EXPECT(ParseNumber("0b111_1111_1111_1111_1111_1111_1111_1111"),
          Holds(std::numeric_limits<i32>::max()));
   EXPECT(ParseNumber("0b10000000000000000000000000000000"),
-         Holds<std::string>());
-  EXPECT(ParseNumber("0b"), Holds<std::string>());
-  EXPECT(ParseNumber("0b_"), Holds<std::string>());
+         Holds(i64{2147483648}));
+  EXPECT(ParseNumber("0b111111111111111111111111111111111111111111111111111111"
+                     "111111111"),
+         Holds(std::numeric_limits<i64>::max()));
+  EXPECT(ParseNumber("0b100000000000000000000000000000000000000000000000000000"
+                     "0000000000"),
+         Holds<std::string_view>());
+  EXPECT(ParseNumber("0b"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0b_"), Holds<std::string_view>());
 }
 
 TEST(Base8Integer) {
@@ -38,11 +44,14 @@ TEST(Base8Integer) {
   EXPECT(ParseNumber("0o17777777777"), Holds(std::numeric_limits<i32>::max()));
   EXPECT(ParseNumber("0o177______________77777_____________777"),
          Holds(std::numeric_limits<i32>::max()));
-  EXPECT(ParseNumber("0o20000000000"), Holds<std::string>());
-  EXPECT(ParseNumber("0o7777777777777777"), Holds<std::string>());
-  EXPECT(ParseNumber("0o77_77_77_77_77_77_77_77"), Holds<std::string>());
-  EXPECT(ParseNumber("0o"), Holds<std::string>());
-  EXPECT(ParseNumber("0o_"), Holds<std::string>());
+  EXPECT(ParseNumber("0o20000000000"), Holds(i64{2147483648}));
+  EXPECT(ParseNumber("0o7777777777777777"), Holds(i64{281474976710655}));
+  EXPECT(ParseNumber("0o77_77_77_77_77_77_77_77"), Holds(i64{281474976710655}));
+  EXPECT(ParseNumber("0o777777777777777777777"),
+         Holds(std::numeric_limits<i64>::max()));
+  EXPECT(ParseNumber("0o1000000000000000000000"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0o"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0o_"), Holds<std::string_view>());
 }
 
 TEST(Base10Integer) {
@@ -51,17 +60,21 @@ TEST(Base10Integer) {
   EXPECT(ParseNumber("0d01"), Holds(1));
   EXPECT(ParseNumber("0d11"), Holds(11));
   EXPECT(ParseNumber("0d2147483647"), Holds(std::numeric_limits<i32>::max()));
-  EXPECT(ParseNumber("0d2147483648"), Holds<std::string>());
-  EXPECT(ParseNumber("0d9999999999"), Holds<std::string>());
+  EXPECT(ParseNumber("0d2147483648"), Holds(i64{2147483648}));
+  EXPECT(ParseNumber("0d9999999999"), Holds(i64{9999999999}));
   EXPECT(ParseNumber("0"), Holds(0));
   EXPECT(ParseNumber("7"), Holds(7));
   EXPECT(ParseNumber("1"), Holds(1));
   EXPECT(ParseNumber("11"), Holds(11));
   EXPECT(ParseNumber("2147483647"), Holds(std::numeric_limits<i32>::max()));
-  EXPECT(ParseNumber("2147483648"), Holds<std::string>());
-  EXPECT(ParseNumber("9999999999"), Holds<std::string>());
-  EXPECT(ParseNumber("0d"), Holds<std::string>());
-  EXPECT(ParseNumber("0d_"), Holds<std::string>());
+  EXPECT(ParseNumber("2147483648"), Holds(i64{2147483648}));
+  EXPECT(ParseNumber("9999999999"), Holds(i64{9999999999}));
+  EXPECT(ParseNumber("9223372036854775807"),
+         Holds(std::numeric_limits<i64>::max()));
+  EXPECT(ParseNumber("9_223_372_036_854_775_808"), Holds<std::string_view>());
+  EXPECT(ParseNumber("99999999999999999999"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0d"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0d_"), Holds<std::string_view>());
 }
 
 TEST(Base16Integer) {
@@ -70,10 +83,13 @@ TEST(Base16Integer) {
   EXPECT(ParseNumber("0x01"), Holds(1));
   EXPECT(ParseNumber("0x11"), Holds(17));
   EXPECT(ParseNumber("0x7fffffff"), Holds(std::numeric_limits<i32>::max()));
-  EXPECT(ParseNumber("0x80000000"), Holds<std::string>());
-  EXPECT(ParseNumber("0xffffffff"), Holds<std::string>());
-  EXPECT(ParseNumber("0x"), Holds<std::string>());
-  EXPECT(ParseNumber("0x_"), Holds<std::string>());
+  EXPECT(ParseNumber("0x80000000"), Holds(i64{2147483648}));
+  EXPECT(ParseNumber("0xffffffff"), Holds(i64{4294967295}));
+  EXPECT(ParseNumber("0x7fff_ffff_ffff_ffff"),
+         Holds(std::numeric_limits<i64>::max()));
+  EXPECT(ParseNumber("0x8000_0000_0000_0000"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0x"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0x_"), Holds<std::string_view>());
 }
 
 TEST(Base2Real) {
@@ -84,8 +100,8 @@ TEST(Base2Real) {
   EXPECT(ParseNumber("0b.1"), Holds(0.5));
   EXPECT(ParseNumber("0b.001"), Holds(0.125));
   EXPECT(ParseNumber("0b_1__0_.1_"), Holds(2.5));
-  EXPECT(ParseNumber("0b_._"), Holds<std::string>());
-  EXPECT(ParseNumber("0b."), Holds<std::string>());
+  EXPECT(ParseNumber("0b_._"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0b."), Holds<std::string_view>());
   // TODO overflow and underflow
 }
 
@@ -98,8 +114,8 @@ TEST(Base8Real) {
   EXPECT(ParseNumber("0o.001"), Holds(0.001953125));
   EXPECT(ParseNumber("0o.04"), Holds(0.0625));
   EXPECT(ParseNumber("0o_1__1_.2_"), Holds(9.25));
-  EXPECT(ParseNumber("0o_._"), Holds<std::string>());
-  EXPECT(ParseNumber("0o."), Holds<std::string>());
+  EXPECT(ParseNumber("0o_._"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0o."), Holds<std::string_view>());
   // TODO overflow and underflow
 }
 
@@ -121,8 +137,19 @@ TEST(Base10Real) {
   EXPECT(ParseNumber("0d.001"), Holds(0.001));
   EXPECT(ParseNumber("0d.04"), Holds(0.04));
   EXPECT(ParseNumber("0d_1__1_.2_"), Holds(11.2));
-  EXPECT(ParseNumber("0d_._"), Holds<std::string>());
-  EXPECT(ParseNumber("0d."), Holds<std::string>());
+  EXPECT(ParseNumber("0d_._"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0d."), Holds<std::string_view>());
+
+  // Results are correctly rounded, including when there are too many digits
+  // for the fast path.
+  EXPECT(ParseNumber("0.30000000000000004"), Holds(0.30000000000000004));
+  EXPECT(ParseNumber("3.141592653589793238462643383279"),
+         Holds(3.141592653589793));
+  EXPECT(ParseNumber("9007199254740993."), Holds(9007199254740992.0));
+  EXPECT(ParseNumber("9007199254740995."), Holds(9007199254740996.0));
+  EXPECT(ParseNumber("123456789012345678901234567890."),
+         Holds(1.2345678901234568e29));
+  EXPECT(ParseNumber(".000000000000000000000000001"), Holds(1e-27));
   // TODO overflow and underflow
 }
 
@@ -134,8 +161,24 @@ TEST(Base16Real) {
   EXPECT(ParseNumber("0x.1"), Holds(0.0625));
   EXPECT(ParseNumber("0x.04"), Holds(0.015625));
   EXPECT(ParseNumber("0x_1__1_.2_"), Holds(17.125));
-  EXPECT(ParseNumber("0x_._"), Holds<std::string>());
-  EXPECT(ParseNumber("0x."), Holds<std::string>());
+  EXPECT(ParseNumber("0x_._"), Holds<std::string_view>());
+  EXPECT(ParseNumber("0x."), Holds<std::string_view>());
+  EXPECT(ParseNumber("0xf.8"), Holds(15.5));
+  EXPECT(ParseNumber("0x20_0000_0000_0001.8"), Holds(9007199254740994.0));
+  EXPECT(ParseNumber("0x1_0000_0000_0000_0000_1."),
+         Holds(18446744073709551616.0 * 16));
 
   // TODO overflow and underflow
 }
+
+TEST(Length) {
+  size_t length;
+  EXPECT(ParseNumber("12)", &length), Holds(12));
+  EXPECT(length == 2u);
+  EXPECT(ParseNumber("0x1f + 3", &length), Holds(31));
+  EXPECT(length == 4u);
+  EXPECT(ParseNumber("1.5.x", &length), Holds<std::string_view>());
+  EXPECT(length == 5u);
+  EXPECT(ParseNumber("0b102", &length), Holds<std::string_view>());
+  EXPECT(length == 5u);
+}
@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <array>
 #include <cstdio>
+#include <future>
 #include <iosfwd>
+#include <limits>
 #include <queue>
+#include <thread>
 #include "base/container/unordered_map.h"
 #include "base/container/vector.h"
 
@@ -136,6 +140,19 @@ static std::unique_ptr<ast::Node> BracedStatementsJumpSameLineEnd(
   return BracedStatementsSameLineEnd(std::move(nodes), ctx);
 }
 
+namespace frontend {
+// Stands in for the statements of a function body which was skipped over, to
+// be parsed only if the function is used.
+struct UnparsedBody : public Token {
+  explicit UnparsedBody(TextSpan const &span, TextSpan const &contents)
+      : Token(span), contents_(contents) {}
+  ~UnparsedBody() override {}
+
+  // Everything between the braces.
+  TextSpan contents_;
+};
+}  // namespace frontend
+
 namespace ast {
 namespace {
 std::unique_ptr<Node> BuildRightUnop(base::vector<std::unique_ptr<Node>> nodes,
@@ -180,7 +197,7 @@ std::unique_ptr<Node> BuildCall(base::vector<std::unique_ptr<Node>> nodes,
           last_named_span_before_error = expr->as<Binop>().lhs->span;
         }
         call->args_.named_.emplace(
-            std::move(expr->as<Binop>().lhs->as<Identifier>().token),
+            std::string(expr->as<Binop>().lhs->as<Identifier>().token.get()),
             std::move(expr->as<Binop>().rhs));
       } else {
         if (last_named_span_before_error.has_value()) {
@@ -198,7 +215,7 @@ std::unique_ptr<Node> BuildCall(base::vector<std::unique_ptr<Node>> nodes,
     if (nodes[2]->is<Binop>() &&
         nodes[2]->as<Binop>().op == Language::Operator::Assign) {
       call->args_.named_.emplace(
-          std::move(nodes[2]->as<Binop>().lhs->as<Identifier>().token),
+          std::string(nodes[2]->as<Binop>().lhs->as<Identifier>().token.get()),
           std::move(nodes[2]->as<Binop>().rhs));
     } else {
       call->args_.pos_.push_back(move_as<Expression>(nodes[2]));
@@ -307,6 +324,7 @@ std::unique_ptr<Node> BuildChainOp(base::vector<std::unique_ptr<Node>> nodes,
   }
 
   chain->ops.push_back(op);
+  chain->syms.emplace_back(nodes[1]->as<frontend::Token>().token);
   chain->exprs.push_back(move_as<Expression>(nodes[2]));
   return chain;
 }
@@ -345,7 +363,7 @@ std::unique_ptr<Node> BuildAccess(base::vector<std::unique_ptr<Node>> nodes,
   if (!nodes[2]->is<Identifier>()) {
     ctx->error_log_.RHSNonIdInAccess(nodes[2]->span);
   } else {
-    access->member_name = std::move(nodes[2]->as<Identifier>().token);
+    access->member_name = nodes[2]->as<Identifier>().token;
   }
   return access;
 }
@@ -495,22 +513,23 @@ base::vector<std::unique_ptr<Declaration>> ExtractInputs(
 
 std::unique_ptr<Node> BuildFunctionLiteral(
     TextSpan span, base::vector<std::unique_ptr<Declaration>> inputs,
-    std::unique_ptr<Expression> output, Statements &&stmts, Context *ctx) {
+    std::unique_ptr<Expression> output, std::unique_ptr<Node> body,
+    Context *ctx) {
   auto fn     = std::make_unique<ast::FunctionLiteral>();
   fn->module_ = ASSERT_NOT_NULL(ctx->mod_);
   for (auto &input : inputs) {
     input->is_fn_param_ = true;
-    // NOTE: This is safe because the declaration is behind a unique_ptr so the
-    // string is never moved. You need to be careful if you ever decide to use
-    // make this declaration inline because SSO might mean moving the
-    // declaration (which can happen if FnParams internal vector gets
-    // reallocated) could invalidate the string_view unintentionally.
-    std::string_view name = input->id_;
+    // NOTE: This is safe because interned symbol text is never moved or freed.
+    std::string_view name = input->id_.get();
     fn->inputs_.append(name, std::move(input));
   }
 
-  fn->span        = std::move(span);
-  fn->statements_ = std::move(stmts);
+  fn->span = std::move(span);
+  if (body->is<frontend::UnparsedBody>()) {
+    fn->unparsed_body_ = body->as<frontend::UnparsedBody>().contents_;
+  } else {
+    fn->statements_ = std::move(body->as<Statements>());
+  }
 
   if (output == nullptr) {
     fn->return_type_inferred_ = true;
@@ -539,7 +558,7 @@ std::unique_ptr<Node> BuildNormalFunctionLiteral(
   auto *binop = &nodes[0]->as<Binop>();
   return BuildFunctionLiteral(
       std::move(span), ExtractInputs(std::move(binop->lhs)),
-      std::move(binop->rhs), std::move(nodes[1]->as<Statements>()), ctx);
+      std::move(binop->rhs), std::move(nodes[1]), ctx);
 }
 
 std::unique_ptr<Node> BuildInferredFunctionLiteral(
@@ -547,7 +566,7 @@ std::unique_ptr<Node> BuildInferredFunctionLiteral(
   auto span = TextSpan(nodes[0]->span, nodes.back()->span);
   return BuildFunctionLiteral(
       std::move(span), ExtractInputs(move_as<Expression>(nodes[0])), nullptr,
-      std::move(nodes[2]->as<Statements>()), ctx);
+      std::move(nodes[2]), ctx);
 }
 
 std::unique_ptr<Node> BuildShortFunctionLiteral(
@@ -569,8 +588,8 @@ std::unique_ptr<Node> BuildShortFunctionLiteral(
     ret->args_.exprs_.push_back(std::move(body));
   }
 
-  Statements stmts;
-  stmts.append(std::move(ret));
+  auto stmts = std::make_unique<Statements>();
+  stmts->append(std::move(ret));
   return BuildFunctionLiteral(std::move(span), std::move(inputs), nullptr,
                               std::move(stmts), ctx);
 }
@@ -677,6 +696,9 @@ struct Rule {
 
   size_t size() const { return input_.size(); }
 
+  // The set of tags accepted `n` entries below the top of the stack.
+  u64 input_from_top(size_t n) const { return input_[input_.size() - 1 - n]; }
+
   bool match(base::vector<frontend::Tag> const &tag_stack) const {
     // The stack needs to be long enough to match.
     if (input_.size() > tag_stack.size()) return false;
@@ -793,6 +815,7 @@ static std::unique_ptr<ast::Node> BuildBinaryOperator(
 
   binop->lhs = move_as<ast::Expression>(nodes[0]);
   binop->rhs = move_as<ast::Expression>(nodes[2]);
+  binop->sym = Symbol(tk);
 
   static base::unordered_map<std::string, Language::Operator> const symbols = {
       {"->", Language::Operator::Arrow}, {"|=", Language::Operator::OrEq},
@@ -1044,7 +1067,8 @@ static std::unique_ptr<ast::Node> Reserved(
   ctx->error_log_.Reserved(nodes[RES]->span,
                            nodes[RES]->as<frontend::Token>().token);
 
-  return std::make_unique<ast::Identifier>(nodes[RTN]->span, "invalid_node");
+  return std::make_unique<ast::Identifier>(nodes[RTN]->span,
+                                           Symbol("invalid_node"));
 }
 
 template <size_t RTN, size_t RES1, size_t RES2>
@@ -1054,14 +1078,16 @@ static std::unique_ptr<ast::Node> BothReserved(
                            nodes[RES1]->as<frontend::Token>().token);
   ctx->error_log_.Reserved(nodes[RES2]->span,
                            nodes[RES2]->as<frontend::Token>().token);
-  return std::make_unique<ast::Identifier>(nodes[RTN]->span, "invalid_node");
+  return std::make_unique<ast::Identifier>(nodes[RTN]->span,
+                                           Symbol("invalid_node"));
 }
 
 static std::unique_ptr<ast::Node> NonBinop(
     base::vector<std::unique_ptr<ast::Node>> nodes, Context *ctx) {
   ctx->error_log_.NotBinary(nodes[1]->span,
                             nodes[1]->as<frontend::Token>().token);
-  return std::make_unique<ast::Identifier>(nodes[1]->span, "invalid_node");
+  return std::make_unique<ast::Identifier>(nodes[1]->span,
+                                           Symbol("invalid_node"));
 }
 
 template <size_t RTN, size_t RES>
@@ -1071,7 +1097,8 @@ static std::unique_ptr<ast::Node> NonBinopReserved(
                             nodes[1]->as<frontend::Token>().token);
   ctx->error_log_.Reserved(nodes[RES]->span,
                            nodes[RES]->as<frontend::Token>().token);
-  return std::make_unique<ast::Identifier>(nodes[RTN]->span, "invalid_node");
+  return std::make_unique<ast::Identifier>(nodes[RTN]->span,
+                                           Symbol("invalid_node"));
 }
 
 static std::unique_ptr<ast::Node> NonBinopBothReserved(
@@ -1082,7 +1109,8 @@ static std::unique_ptr<ast::Node> NonBinopBothReserved(
                             nodes[1]->as<frontend::Token>().token);
   ctx->error_log_.Reserved(nodes[2]->span,
                            nodes[2]->as<frontend::Token>().token);
-  return std::make_unique<ast::Identifier>(nodes[1]->span, "invalid_node");
+  return std::make_unique<ast::Identifier>(nodes[1]->span,
+                                           Symbol("invalid_node"));
 }
 }  // namespace ErrMsg
 
@@ -1090,7 +1118,7 @@ static std::unique_ptr<ast::Node> BuildOperatorIdentifier(
     base::vector<std::unique_ptr<ast::Node>> nodes, Context *ctx) {
   auto span = nodes[1]->span;
   return std::make_unique<ast::Identifier>(
-      span, move_as<frontend::Token>(nodes[1])->token);
+      span, Symbol(nodes[1]->as<frontend::Token>().token));
 }
 
 namespace frontend {
@@ -1200,7 +1228,57 @@ auto Rules = std::array{
          ast::SugaredExtendScopeNode),
 };
 
+// Every tag is a single bit, so the tag on top of the stack, along with the one
+// below it, selects the few rules which could possibly match. Candidates are
+// kept in the same order as `Rules`, so the first one to match is the same
+// rule a scan over all of `Rules` would have found.
+struct RuleTable {
+  static constexpr size_t kNumTags = 32;
+  static_assert(fn_call_expr == (1ull << (kNumTags - 1)));
+  // Stands in for the tag below the top when the stack holds only one node.
+  static constexpr size_t kNoTag = kNumTags;
+
+  RuleTable() {
+    for (Rule const &rule : Rules) {
+      for (size_t top = 0; top < kNumTags; ++top) {
+        if ((rule.input_from_top(0) & (1ull << top)) == 0) { continue; }
+        for (size_t below = 0; below <= kNoTag; ++below) {
+          bool below_matches = (below == kNoTag)
+                                   ? rule.size() == 1
+                                   : (rule.size() == 1 ||
+                                      (rule.input_from_top(1) &
+                                       (1ull << below)) != 0);
+          if (below_matches) { candidates_[top][below].push_back(&rule); }
+        }
+      }
+    }
+  }
+
+  base::vector<Rule const *> const &candidates(
+      base::vector<Tag> const &tag_stack) const {
+    size_t size  = tag_stack.size();
+    size_t top   = Index(tag_stack[size - 1]);
+    size_t below = size == 1 ? kNoTag : Index(tag_stack[size - 2]);
+    return candidates_[top][below];
+  }
+
+ private:
+  static size_t Index(Tag tag) {
+    ASSERT(tag != 0u);
+    ASSERT((tag & (tag - 1)) == 0u);
+    return static_cast<size_t>(__builtin_ctzll(tag));
+  }
+
+  std::array<std::array<base::vector<Rule const *>, kNoTag + 1>, kNumTags>
+      candidates_;
+};
+
 TaggedNode NextToken(SourceLocation &loc, error::Log *error_log);
+// If `loc` is just past the opening brace of a function body, moves it past
+// the matching closing brace without lexing anything in between, sets `body`
+// to the span between the braces and returns true. Returns false, leaving
+// `loc` where it was, if the body is not one that may be skipped.
+bool SkipFunctionBody(SourceLocation &loc, TextSpan *body);
 
 namespace {
 enum class ShiftState : char { NeedMore, EndOfExpr, MustReduce };
@@ -1313,6 +1391,14 @@ struct ParseState {
     return ShiftState::MustReduce;
   }
 
+  // Whether the brace just shifted opens the body of a function with a
+  // declared return type, which may be left unparsed until it is needed.
+  bool MaySkipFunctionBody() const {
+    return ctx_->mod_->lazy_function_bodies_ && lookahead_.empty() &&
+           tag_stack_.size() >= 2 && get_type<1>() == l_brace &&
+           get_type<2>() == fn_expr;
+  }
+
   void LookAhead() { lookahead_.push(NextToken(*loc_, &ctx_->error_log_)); }
 
   const TaggedNode &Next() {
@@ -1340,7 +1426,8 @@ static void Debug(frontend::ParseState *ps) {
   // Clear the screen
   fprintf(stderr, "\033[2J\033[1;1H\n");
   if (ps->loc_ != nullptr) {
-    fprintf(stderr, "%s\n", ps->loc_->line().c_str());
+    auto line = ps->loc_->line();
+    fprintf(stderr, "%.*s\n", static_cast<int>(line.size()), line.data());
     fprintf(stderr, "%*s^\n(offset = %u)\n\n",
             static_cast<int>(ps->loc_->cursor.offset), "",
             ps->loc_->cursor.offset);
@@ -1362,6 +1449,19 @@ static void Shift(frontend::ParseState *ps) {
   ps->tag_stack_.push_back(ahead.tag_);
   ps->node_stack_.push_back(std::move(ahead.node_));
 
+  if (ps->MaySkipFunctionBody()) {
+    TextSpan contents;
+    if (frontend::SkipFunctionBody(*ps->loc_, &contents)) {
+      auto span   = ps->node_stack_.back()->span;
+      span.finish = ps->loc_->cursor;
+      ps->tag_stack_.back() = frontend::braced_stmts;
+      ps->node_stack_.back() =
+          std::make_unique<frontend::UnparsedBody>(span, contents);
+      // The closing brace is never lexed, so it must be accounted for here.
+      --ps->brace_count;
+    }
+  }
+
   auto tag_ahead = ps->Next().tag_;
   if (tag_ahead &
       (frontend::l_paren | frontend::l_bracket | frontend::l_brace)) {
@@ -1373,10 +1473,13 @@ static void Shift(frontend::ParseState *ps) {
 }
 
 static bool Reduce(frontend::ParseState *ps) {
+  if (ps->tag_stack_.empty()) { return false; }
+  static frontend::RuleTable const rule_table;
+
   const Rule *matched_rule_ptr = nullptr;
-  for (const Rule &rule : frontend::Rules) {
-    if (rule.match(ps->tag_stack_)) {
-      matched_rule_ptr = &rule;
+  for (const Rule *rule : rule_table.candidates(ps->tag_stack_)) {
+    if (rule->match(ps->tag_stack_)) {
+      matched_rule_ptr = rule;
       break;
     }
   }
@@ -1434,10 +1537,10 @@ std::unique_ptr<ast::Statements> frontend::Repl::Parse(Context *ctx) {
   }
 }
 
-std::unique_ptr<ast::Statements> frontend::File::Parse(Context *ctx) {
-  SourceLocation loc;
-  loc.source = this;
-
+// Parses statements from `loc` until it reaches the end of its range. Returns
+// null if they could not be parsed, having logged an error.
+static std::unique_ptr<ast::Statements> ParseStatements(SourceLocation loc,
+                                                        Context *ctx) {
   auto state = frontend::ParseState(&loc, ctx);
   Shift(&state);
 
@@ -1471,7 +1574,232 @@ std::unique_ptr<ast::Statements> frontend::File::Parse(Context *ctx) {
 
     // This is an exceedingly crappy error message.
     ctx->error_log_.UnknownParseError(lines);
+    return nullptr;
   }
 
   return move_as<ast::Statements>(state.node_stack_.back());
 }
+
+// Parses lines `first_line_num` through `last_line_num` of `source`.
+static std::unique_ptr<ast::Statements> ParseLines(frontend::Source *source,
+                                                   u32 first_line_num,
+                                                   u32 last_line_num,
+                                                   Context *ctx) {
+  SourceLocation loc;
+  loc.source = source;
+  // Start at the end of the preceding line (line 0 being empty) so that, just
+  // as at the start of a file, the first token is a newline.
+  loc.cursor.line_num = first_line_num - 1;
+  loc.cursor.offset =
+      static_cast<u32>(source->line_size(loc.cursor.line_num));
+  loc.end.line_num = last_line_num;
+  return ParseStatements(loc, ctx);
+}
+
+namespace frontend {
+std::unique_ptr<ast::Statements> ParseFunctionBody(TextSpan const &contents,
+                                                   Context *ctx) {
+  SourceLocation loc;
+  loc.source = contents.source;
+  loc.cursor = contents.start;
+  loc.end    = contents.finish;
+  return ParseStatements(loc, ctx);
+}
+
+namespace {
+// Files smaller than this are always parsed on a single thread.
+constexpr size_t kMinParallelParseBytes = 256 * 1024;
+// The smallest amount of source worth handing to a thread of its own.
+constexpr size_t kMinChunkBytes = 64 * 1024;
+
+constexpr bool IsWordChar(char c) {
+  return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') ||
+         ('0' <= c && c <= '9') || c == '_';
+}
+
+// Tracks just enough of the structure of a file, one line at a time, to tell
+// where a top-level statement may begin.
+struct TopLevelScanner {
+  void ScanLine(std::string_view line) {
+    for (size_t i = 0; i < line.size(); ++i) {
+      char c    = line[i];
+      char next = (i + 1 < line.size()) ? line[i + 1] : '\0';
+      if (comment_depth_ > 0) {
+        if (c == '*' && next == '/') {
+          --comment_depth_;
+          ++i;
+        } else if (c == '/' && next == '*') {
+          ++comment_depth_;
+          ++i;
+        }
+        continue;
+      }
+
+      switch (c) {
+        case ' ':
+        case '\t':
+        case '\r': break;
+        case '/':
+          if (next == '/') { return; }
+          if (next == '*') {
+            ++comment_depth_;
+            ++i;
+          } else {
+            ends_statement_ = false;
+          }
+          break;
+        case '"':
+          for (++i; i < line.size() && line[i] != '"'; ++i) {
+            if (line[i] == '\\') { ++i; }
+          }
+          ends_statement_ = true;
+          break;
+        case '#':
+          // A hashtag applies to whatever follows it, possibly on a later line.
+          while (i + 1 < line.size() &&
+                 (IsWordChar(line[i + 1]) || line[i + 1] == '{' ||
+                  line[i + 1] == '}')) {
+            ++i;
+          }
+          ends_statement_ = false;
+          break;
+        case '(':
+        case '[':
+        case '{':
+          ++depth_;
+          ends_statement_ = false;
+          break;
+        case ')':
+        case ']':
+        case '}':
+          --depth_;
+          ends_statement_ = true;
+          break;
+        default:
+          if (!IsWordChar(c)) {
+            ends_statement_ = false;
+            break;
+          }
+          size_t word_start = i;
+          while (i + 1 < line.size() && IsWordChar(line[i + 1])) { ++i; }
+          ends_statement_ = !ContinuesOntoNextLine(
+              line.substr(word_start, i + 1 - word_start));
+      }
+    }
+  }
+
+  // Whether a top-level statement may begin on a line starting with `line`,
+  // given everything scanned so far. Conservative: missing a place where a
+  // statement begins only costs parallelism.
+  bool AtStatementBoundary(std::string_view line) const {
+    if (line.empty() || !IsWordChar(line[0]) || ('0' <= line[0] &&
+                                                   line[0] <= '9')) {
+      return false;
+    }
+    return depth_ == 0 && comment_depth_ == 0 && ends_statement_;
+  }
+
+ private:
+  // Keywords after which the parser may keep reading past the newline.
+  static bool ContinuesOntoNextLine(std::string_view word) {
+    static constexpr std::string_view kKeywords[] = {
+        "as",        "block",  "copy",   "ensure", "enum",
+        "flags",     "generate", "import", "interface",
+        "move",      "needs",  "print",  "return", "scope",
+        "struct",    "switch", "when",   "which",  "yield"};
+    return std::find(std::begin(kKeywords), std::end(kKeywords), word) !=
+           std::end(kKeywords);
+  }
+
+  int depth_           = 0;
+  int comment_depth_   = 0;
+  bool ends_statement_ = false;
+};
+
+// Splits `source` into at most `max_chunks` runs of lines of roughly equal
+// size, each beginning at the start of a top-level statement. Returns the
+// first and last line of each run.
+base::vector<std::pair<u32, u32>> SplitIntoChunks(Source const &source,
+                                                  size_t max_chunks) {
+  size_t total_bytes = 0;
+  for (u32 n = 1; n <= source.last_line_num(); ++n) {
+    total_bytes += source.line_size(n) + 1;
+  }
+  size_t target_bytes = std::max(kMinChunkBytes, total_bytes / max_chunks);
+
+  base::vector<std::pair<u32, u32>> chunks;
+  TopLevelScanner scanner;
+  u32 chunk_start    = 1;
+  size_t chunk_bytes = 0;
+  for (u32 n = 1; n <= source.last_line_num(); ++n) {
+    std::string_view line = source.line(n);
+    if (chunk_bytes >= target_bytes && chunks.size() + 1 < max_chunks &&
+        scanner.AtStatementBoundary(line)) {
+      chunks.emplace_back(chunk_start, n - 1);
+      chunk_start = n;
+      chunk_bytes = 0;
+    }
+    scanner.ScanLine(line);
+    chunk_bytes += line.size() + 1;
+  }
+  chunks.emplace_back(chunk_start, source.last_line_num());
+  return chunks;
+}
+
+// Parses each chunk on its own thread, with its own arena and error log, and
+// concatenates the results. Returns null if any chunk had errors, so that the
+// caller can reparse the whole file and report them exactly as it would have.
+std::unique_ptr<ast::Statements> ParseChunks(
+    Source *source, base::vector<std::pair<u32, u32>> const &chunks,
+    Context *ctx) {
+  struct ChunkResult {
+    std::unique_ptr<ast::Statements> stmts_;
+    bool ok_ = false;
+  };
+
+  base::vector<std::future<ChunkResult>> futures;
+  futures.reserve(chunks.size());
+  for (auto const & [ first, last ] : chunks) {
+    // Arenas are created here rather than on the parsing threads, since
+    // `ast_arenas_` is not thread-safe.
+    auto *arena = &ctx->mod_->ast_arenas_.emplace_back();
+    futures.push_back(std::async(
+        std::launch::async, [ source, first = first, last = last, arena, ctx ] {
+          ast::NodeArenaScope arena_scope(arena);
+          Context chunk_ctx(ctx->mod_);
+          ChunkResult result;
+          result.stmts_ = ParseLines(source, first, last, &chunk_ctx);
+          result.ok_    = (chunk_ctx.num_errors() == 0);
+          return result;
+        }));
+  }
+
+  base::vector<ChunkResult> results;
+  results.reserve(futures.size());
+  for (auto &f : futures) { results.push_back(f.get()); }
+  for (auto const &result : results) {
+    if (!result.ok_) { return nullptr; }
+  }
+
+  auto stmts = std::move(results[0].stmts_);
+  for (size_t i = 1; i < results.size(); ++i) {
+    for (auto &node : results[i].stmts_->content_) {
+      stmts->content_.push_back(std::move(node));
+    }
+    stmts->span = TextSpan(stmts->span, results[i].stmts_->span);
+  }
+  return stmts;
+}
+}  // namespace
+}  // namespace frontend
+
+std::unique_ptr<ast::Statements> frontend::File::Parse(Context *ctx) {
+  size_t num_threads = std::thread::hardware_concurrency();
+  if (num_threads > 1 && buffer_.size() >= kMinParallelParseBytes) {
+    auto chunks = SplitIntoChunks(*this, num_threads);
+    if (chunks.size() > 1) {
+      if (auto stmts = ParseChunks(this, chunks, ctx)) { return stmts; }
+    }
+  }
+  return ParseLines(this, 1, std::numeric_limits<u32>::max(), ctx);
+}
@@ -0,0 +1,121 @@
+#include "frontend/scan.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "base/types.h"
+
+namespace frontend {
+namespace {
+#if defined(__AVX2__)
+#define ICARUS_SCAN_SIMD
+using Vec               = __m256i;
+constexpr u32 kAllLanes = 0xffffffff;
+static_assert(sizeof(Vec) <= kScanPadding);
+
+Vec Load(char const *p) {
+  return _mm256_loadu_si256(reinterpret_cast<Vec const *>(p));
+}
+Vec Splat(char c) { return _mm256_set1_epi8(c); }
+Vec Eq(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+Vec Gt(Vec a, Vec b) { return _mm256_cmpgt_epi8(a, b); }
+Vec And(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+Vec Or(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+u32 Lanes(Vec v) { return static_cast<u32>(_mm256_movemask_epi8(v)); }
+#elif defined(__SSE2__)
+#define ICARUS_SCAN_SIMD
+using Vec               = __m128i;
+constexpr u32 kAllLanes = 0xffff;
+static_assert(sizeof(Vec) <= kScanPadding);
+
+Vec Load(char const *p) {
+  return _mm_loadu_si128(reinterpret_cast<Vec const *>(p));
+}
+Vec Splat(char c) { return _mm_set1_epi8(c); }
+Vec Eq(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+Vec Gt(Vec a, Vec b) { return _mm_cmpgt_epi8(a, b); }
+Vec And(Vec a, Vec b) { return _mm_and_si128(a, b); }
+Vec Or(Vec a, Vec b) { return _mm_or_si128(a, b); }
+u32 Lanes(Vec v) { return static_cast<u32>(_mm_movemask_epi8(v)); }
+#endif
+
+#ifdef ICARUS_SCAN_SIMD
+// Lanes holding a character in [lo, hi]. The comparisons are signed, so this
+// only works for ASCII bounds, and non-ASCII bytes are never in range.
+Vec InRange(Vec v, char lo, char hi) {
+  return And(Gt(v, Splat(static_cast<char>(lo - 1))),
+             Gt(Splat(static_cast<char>(hi + 1)), v));
+}
+
+// Advances past every character for which `in_class` sets the lane, one
+// vector at a time.
+template <typename InClass>
+char const *Skip(char const *p, InClass in_class) {
+  while (true) {
+    u32 misses = ~Lanes(in_class(Load(p))) & kAllLanes;
+    if (misses != 0) { return p + __builtin_ctz(misses); }
+    p += sizeof(Vec);
+  }
+}
+
+template <typename InClass>
+char const *Find(char const *p, InClass in_class) {
+  while (true) {
+    u32 hits = Lanes(in_class(Load(p)));
+    if (hits != 0) { return p + __builtin_ctz(hits); }
+    p += sizeof(Vec);
+  }
+}
+#endif  // ICARUS_SCAN_SIMD
+}  // namespace
+
+char const *SkipBlanks(char const *p) {
+#ifdef ICARUS_SCAN_SIMD
+  return Skip(p,
+              [](Vec v) { return Or(Eq(v, Splat(' ')), Eq(v, Splat('\t'))); });
+#else
+  while (*p == ' ' || *p == '\t') { ++p; }
+  return p;
+#endif
+}
+
+char const *SkipWordChars(char const *p) {
+#ifdef ICARUS_SCAN_SIMD
+  return Skip(p, [](Vec v) {
+    return Or(Or(InRange(v, 'a', 'z'), InRange(v, 'A', 'Z')),
+              Or(InRange(v, '0', '9'), Eq(v, Splat('_'))));
+  });
+#else
+  while (('a' <= *p && *p <= 'z') || ('A' <= *p && *p <= 'Z') ||
+         ('0' <= *p && *p <= '9') || *p == '_') {
+    ++p;
+  }
+  return p;
+#endif
+}
+
+char const *FindStringLiteralSpecial(char const *p) {
+#ifdef ICARUS_SCAN_SIMD
+  return Find(p, [](Vec v) {
+    return Or(Or(Eq(v, Splat('"')), Eq(v, Splat('\\'))), Eq(v, Splat('\0')));
+  });
+#else
+  while (*p != '"' && *p != '\\' && *p != '\0') { ++p; }
+  return p;
+#endif
+}
+
+char const *FindCommentDelimiter(char const *p) {
+#ifdef ICARUS_SCAN_SIMD
+  return Find(p, [](Vec v) {
+    return Or(Or(Eq(v, Splat('*')), Eq(v, Splat('/'))), Eq(v, Splat('\0')));
+  });
+#else
+  while (*p != '*' && *p != '/' && *p != '\0') { ++p; }
+  return p;
+#endif
+}
+}  // namespace frontend
@@ -0,0 +1,29 @@
+#ifndef ICARUS_FRONTEND_SCAN_H
+#define ICARUS_FRONTEND_SCAN_H
+
+#include <cstddef>
+
+// Routines for the lexer's inner loops, which skip over runs of characters
+// many bytes at a time (using SSE2 or AVX2 when available). Each one stops at
+// the first '\0', so they never run past the end of a line held in a
+// `Source`. They may read up to `kScanPadding` bytes past the character they
+// stop at, which `Source` guarantees are readable.
+namespace frontend {
+constexpr size_t kScanPadding = 32;
+
+// Returns a pointer to the first character at or after `p` which is not a
+// space or a tab.
+char const *SkipBlanks(char const *p);
+
+// Returns a pointer to the first character at or after `p` which cannot appear
+// in an identifier (i.e., is not in [a-zA-Z0-9_]).
+char const *SkipWordChars(char const *p);
+
+// Returns a pointer to the first '"', '\\' or '\0' at or after `p`.
+char const *FindStringLiteralSpecial(char const *p);
+
+// Returns a pointer to the first '*', '/' or '\0' at or after `p`.
+char const *FindCommentDelimiter(char const *p);
+}  // namespace frontend
+
+#endif  // ICARUS_FRONTEND_SCAN_H
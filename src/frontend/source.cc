@@ -1,20 +1,55 @@
 #include "frontend/source.h"
+
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
 namespace frontend {
-std::optional<Source::Line> File::NextLine() {
-  if (ifs.eof()) { return std::nullopt; }
-  std::string temp;
-  std::getline(ifs, temp);
-  return Line(std::move(temp));
+void Source::AppendLine(std::string_view text) {
+  buffer_.resize(line_starts_.back());
+  buffer_.append(text);
+  buffer_.push_back('\0');
+  line_starts_.push_back(static_cast<u32>(buffer_.size()));
+  buffer_.resize(buffer_.size() + kScanPadding, '\0');
+}
+
+File::File(Source::Name source_name) : Source(std::move(source_name)) {
+  std::error_code ec;
+  mtime = std::filesystem::last_write_time(name, ec);
+  std::ifstream ifs(name.c_str(), std::ifstream::in | std::ifstream::binary);
+  if (!ifs) { return; }
+  ifs.seekg(0, std::ios::end);
+  auto size = static_cast<size_t>(ifs.tellg());
+  ifs.seekg(0, std::ios::beg);
+
+  // The extra byte terminates the last line, in case the file does not end in
+  // a newline.
+  buffer_.resize(1 + size + 1 + kScanPadding, '\0');
+  ifs.read(buffer_.data() + 1, static_cast<std::streamsize>(size));
+  content_hash =
+      std::hash<std::string_view>{}(std::string_view(buffer_.data() + 1, size));
+
+  char *end = buffer_.data() + 1 + size;
+  for (char *p = buffer_.data() + 1;;) {
+    char *newline = static_cast<char *>(std::memchr(p, '\n', end - p));
+    if (newline == nullptr) { break; }
+    *newline = '\0';
+    p        = newline + 1;
+    line_starts_.push_back(static_cast<u32>(p - buffer_.data()));
+  }
+  // A file without a trailing newline has one more line after the last
+  // newline. One with a trailing newline is treated as ending in an empty
+  // line.
+  line_starts_.push_back(static_cast<u32>(end + 1 - buffer_.data()));
 }
 
-std::optional<Source::Line> Repl::NextLine() {
+bool Repl::LoadNextLine() {
   std::cout << (first_entry ? "\n>> " : ".. ");
   first_entry = false;
   std::string input;
   std::getline(std::cin, input);
   input += '\n';
-  return Line(input);
+  AppendLine(input);
+  return true;
 }
 }  // namespace frontend
@@ -1,11 +1,13 @@
 #ifndef ICARUS_FRONTEND_SOURCE_H
 #define ICARUS_FRONTEND_SOURCE_H
 
-#include <fstream>
+#include <filesystem>
 #include <memory>
-#include <optional>
 #include <string>
+#include <string_view>
 #include "base/container/vector.h"
+#include "base/types.h"
+#include "frontend/scan.h"
 
 struct Context;
 
@@ -14,47 +16,75 @@ struct Statements;
 }
 
 namespace frontend {
+// The text of a source is held in a single contiguous buffer, alongside an
+// index of where each line starts. Each line is followed in the buffer by a
+// '\0' in place of its newline, so the lexer can read one past the end of any
+// line. The buffer is padded past the last line so that the routines in
+// frontend/scan.h can read ahead of any character in it.
 struct Source {
   using Name = std::string;
-  using Line = std::string;
 
   virtual ~Source() {}
-  virtual std::optional<Line> NextLine()                    = 0;
   virtual std::unique_ptr<ast::Statements> Parse(Context *) = 0;
 
-  base::vector<Line> lines{
-      1};  // Start with one blank line because line numbers
-           // are 1-indexed not 0-indexed.
-  // TODO this is a hacky way to do it and you should just shift the counter by
-  // one.
+  // Reads more of the source, if there is any. Returns false at the end of the
+  // source.
+  virtual bool LoadNextLine() = 0;
+
+  // Line numbers are 1-indexed. The returned view does not include the
+  // terminating '\0' and is invalidated by `LoadNextLine`.
+  std::string_view line(size_t line_num) const {
+    return std::string_view(buffer_.data() + line_starts_.at(line_num),
+                            line_starts_.at(line_num + 1) -
+                                line_starts_[line_num] - 1);
+  }
+  size_t line_size(size_t line_num) const {
+    return line_starts_[line_num + 1] - line_starts_[line_num] - 1;
+  }
+  char const &at(size_t line_num, size_t offset) const {
+    return buffer_[line_starts_[line_num] + offset];
+  }
+  // The number of the last line read so far.
+  size_t last_line_num() const { return line_starts_.size() - 2; }
 
   Name name;
-  bool seen_eof = false;
 
  protected:
-  Source(Name name) : name(std::move(name)) {}
+  // Starts with an empty line 0 so that line numbers can be used as indices.
+  Source(Name name)
+      : name(std::move(name)),
+        buffer_(1 + kScanPadding, '\0'),
+        line_starts_{0, 1} {}
+
+  void AppendLine(std::string_view text);
+
+  std::string buffer_;
+  base::vector<u32> line_starts_;
 };
 
 struct Repl : public Source {
   ~Repl() final {}
   Repl() : Source(Source::Name("")) {}
 
-  std::optional<Source::Line> NextLine() final;
+  bool LoadNextLine() final;
   std::unique_ptr<ast::Statements> Parse(Context *) final;
 
   bool first_entry = true;
 };
 
+// Reads the entire file up front with a single read.
 struct File : Source {
-  File(Source::Name source_name)
-      : Source(std::move(source_name)), ifs(name.c_str(), std::ifstream::in) {}
+  File(Source::Name source_name);
   ~File() final {}
 
-  std::optional<Source::Line> NextLine() final;
+  bool LoadNextLine() final { return false; }
   std::unique_ptr<ast::Statements> Parse(Context *) final;
 
   ast::Statements *ast = nullptr;
-  std::ifstream ifs;
+  // The file's modification time, taken before it was read, and a hash of the
+  // bytes read, so that callers can tell whether the file has changed since.
+  std::filesystem::file_time_type mtime;
+  size_t content_hash = 0;
 };
 }  // namespace frontend
 
@@ -2,26 +2,24 @@
 
 #include "base/debug.h"
 
-static void IncrementCursor(frontend::Source *source, Cursor *cursor) {
-  if (cursor->offset != source->lines[cursor->line_num].size()) {
-    ++cursor->offset;
-  } else {
-    ASSERT(source != nullptr);
-    auto next = source->NextLine();
-    if (!next) {
-      source->seen_eof = true;
-    } else {
-      source->lines.push_back(std::move(*next));
-      cursor->offset = 0;
-      ++cursor->line_num;
-    }
-  }
-}
 
 TextSpan::TextSpan(TextSpan const &s, TextSpan const &f)
     : start(s.start), finish(f.finish), source(ASSERT_NOT_NULL(s.source)) {
   ASSERT(s.source == f.source);
 }
 
-void TextSpan::Increment() { IncrementCursor(source, &finish); }
-void SourceLocation::Increment() { IncrementCursor(source, &cursor); }
+void SourceLocation::Increment() {
+  if (cursor.offset != source->line_size(cursor.line_num)) {
+    ++cursor.offset;
+  } else if (cursor.line_num < end.line_num &&
+             (cursor.line_num < source->last_line_num() ||
+              source->LoadNextLine())) {
+    cursor.offset = 0;
+    ++cursor.line_num;
+  } else {
+    seen_eof = true;
+  }
+  if (cursor.line_num == end.line_num && cursor.offset >= end.offset) {
+    seen_eof = true;
+  }
+}
@@ -1,6 +1,8 @@
 #ifndef ICARUS_FRONTEND_TEXT_SPAN_H
 #define ICARUS_FRONTEND_TEXT_SPAN_H
 
+#include <limits>
+
 #include "base/debug.h"
 #include "base/interval.h"
 #include "base/types.h"
@@ -16,10 +18,7 @@ struct TextSpan {
   TextSpan(const Cursor &s, const Cursor &f) : start(s), finish(f) {}
   TextSpan(const TextSpan &s, const TextSpan &f);
 
-  char last_char() const {
-    return source->lines[finish.line_num][finish.offset];
-  }
-  void Increment();
+  char last_char() const { return source->at(finish.line_num, finish.offset); }
 
   base::Interval<size_t> lines() const {
     return base::Interval<size_t>{start.line_num, finish.line_num + 1};
@@ -33,18 +32,33 @@ struct TextSpan {
 struct SourceLocation {
   // Get the character that the cursor is currently pointing to
   const char &operator*() const {
-    return source->lines[cursor.line_num][cursor.offset];
-  }
-  const frontend::Source::Line &line() const {
-    return source->lines[cursor.line_num];
+    return source->at(cursor.line_num, cursor.offset);
   }
+  std::string_view line() const { return source->line(cursor.line_num); }
   TextSpan ToSpan() const {
     TextSpan span(cursor, cursor);
     span.source = source;
     return span;
   }
 
-  void SkipToEndOfLine() { cursor.offset = static_cast<u32>(line().size()); }
+  // Points to the current character. The rest of the current line, its
+  // terminating '\0', and the padding described in frontend/scan.h may be read
+  // through it.
+  char const *data() const { return &**this; }
+
+  // Moves the cursor to `p`, which must be in the current line at or after the
+  // current character (or its terminating '\0').
+  void MoveTo(char const *p) {
+    ASSERT(p >= data());
+    cursor.offset += static_cast<u32>(p - data());
+    if (cursor.line_num == end.line_num && cursor.offset >= end.offset) {
+      seen_eof = true;
+    }
+  }
+
+  void SkipToEndOfLine() {
+    cursor.offset = static_cast<u32>(source->line_size(cursor.line_num));
+  }
 
   void BackUp() {
     // You can't back up to a previous line.
@@ -56,6 +70,13 @@ struct SourceLocation {
 
   Cursor cursor;
   frontend::Source *source = nullptr;
+
+  // Lexing stops on reaching this position, so that several locations can lex
+  // disjoint ranges of the same source at once. By default, lexing continues
+  // to the end of the source.
+  Cursor end{std::numeric_limits<u32>::max(), std::numeric_limits<u32>::max()};
+  // Set once the cursor can advance no further.
+  bool seen_eof = false;
 };
 
 #endif  // ICARUS_FRONTEND_TEXT_SPAN_H
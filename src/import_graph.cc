@@ -1,34 +1,180 @@
 #include "import_graph.h"
 
+#include <algorithm>
 #include <queue>
 
+using PathPtr = std::filesystem::path const *;
+
 std::pair<std::filesystem::path const *, bool> ImportGraph::node(
     std::filesystem::path const &p) {
   std::error_code ec;
   auto canonical_path = std::filesystem::canonical(p, ec);
   if (ec) { return std::pair(nullptr, false); }
   auto[iter, newly_inserted] = all_paths_.insert(canonical_path);
+  if (newly_inserted) { order_.emplace(&*iter, order_.size()); }
   return std::pair(&*iter, newly_inserted);
 }
 
-bool ImportGraph::AddDependency(std::filesystem::path const *dependee,
-                                std::filesystem::path const *depender) {
-  if (depender == dependee) { return false; }
-  std::unordered_set<std::filesystem::path const *> handled;
-  std::queue<std::filesystem::path const *> to_process;
-  to_process.push(dependee);
-  while (!to_process.empty()) {
-    auto elem = to_process.front();
-    if (elem == depender) { return false; }
-    auto[iter, newly_inserted] = handled.insert(elem);
-    to_process.pop();
-    if (newly_inserted) {
-      auto deps_iter = import_deps_.find(elem);
-      if (deps_iter != import_deps_.end()) {
-        for (auto path : deps_iter->second) { to_process.push(path); }
+base::vector<std::filesystem::path const *> ImportGraph::paths() const {
+  base::vector<PathPtr> result;
+  result.reserve(all_paths_.size());
+  for (auto const &path : all_paths_) { result.push_back(&path); }
+  return result;
+}
+
+base::vector<std::filesystem::path const *> ImportGraph::AddDependency(
+    std::filesystem::path const *dependee,
+    std::filesystem::path const *depender) {
+  if (depender == dependee) { return {depender, depender}; }
+  if (import_deps_[depender].count(dependee) != 0) { return {}; }
+
+  size_t lower_bound = order_.at(depender);
+  size_t upper_bound = order_.at(dependee);
+  if (upper_bound > lower_bound) {
+    // The new edge goes against the current order, so every path in
+    // [lower_bound, upper_bound] reachable from either endpoint needs to be
+    // shuffled. First find everything which (transitively) imports
+    // `depender`, bailing out if `dependee` is among them.
+    base::unordered_map<PathPtr, PathPtr> importer_of;
+    base::vector<PathPtr> forward{depender};
+    base::vector<PathPtr> to_process{depender};
+    importer_of.emplace(depender, nullptr);
+    while (!to_process.empty()) {
+      auto elem = to_process.back();
+      to_process.pop_back();
+      if (elem == dependee) {
+        base::vector<PathPtr> cycle{depender};
+        for (auto p = dependee; p != nullptr; p = importer_of.at(p)) {
+          cycle.push_back(p);
+        }
+        return cycle;
+      }
+
+      auto iter = importers_.find(elem);
+      if (iter == importers_.end()) { continue; }
+      for (auto path : iter->second) {
+        if (order_.at(path) > upper_bound) { continue; }
+        if (!importer_of.emplace(path, elem).second) { continue; }
+        forward.push_back(path);
+        to_process.push_back(path);
       }
     }
+
+    // Then everything `dependee` (transitively) imports.
+    std::unordered_set<PathPtr> handled{dependee};
+    base::vector<PathPtr> backward{dependee};
+    to_process.push_back(dependee);
+    while (!to_process.empty()) {
+      auto elem = to_process.back();
+      to_process.pop_back();
+
+      auto iter = import_deps_.find(elem);
+      if (iter == import_deps_.end()) { continue; }
+      for (auto path : iter->second) {
+        if (order_.at(path) < lower_bound) { continue; }
+        if (!handled.insert(path).second) { continue; }
+        backward.push_back(path);
+        to_process.push_back(path);
+      }
+    }
+
+    // Reuse the positions held by both sets, placing the imports of
+    // `dependee` ahead of the importers of `depender` and otherwise
+    // preserving their relative order.
+    auto by_order = [this](PathPtr lhs, PathPtr rhs) {
+      return order_.at(lhs) < order_.at(rhs);
+    };
+    std::sort(backward.begin(), backward.end(), by_order);
+    std::sort(forward.begin(), forward.end(), by_order);
+
+    base::vector<size_t> positions;
+    positions.reserve(backward.size() + forward.size());
+    for (auto path : backward) { positions.push_back(order_.at(path)); }
+    for (auto path : forward) { positions.push_back(order_.at(path)); }
+    std::sort(positions.begin(), positions.end());
+
+    auto pos_iter = positions.begin();
+    for (auto path : backward) { order_.at(path) = *pos_iter++; }
+    for (auto path : forward) { order_.at(path) = *pos_iter++; }
   }
+
   import_deps_[depender].insert(dependee);
-  return true;
+  importers_[dependee].insert(depender);
+  return {};
+}
+
+base::vector<std::filesystem::path const *> ImportGraph::CriticalPathSchedule()
+    const {
+  base::vector<PathPtr> topological(order_.size(), nullptr);
+  for (auto const & [ path, index ] : order_) { topological[index] = path; }
+
+  // Length of the longest chain of importers sitting above each path. Every
+  // importer is ordered later, so walking backwards sees them first.
+  base::unordered_map<PathPtr, size_t> chain_length;
+  for (auto iter = topological.rbegin(); iter != topological.rend(); ++iter) {
+    size_t length = 0;
+    if (auto importers_iter = importers_.find(*iter);
+        importers_iter != importers_.end()) {
+      for (auto importer : importers_iter->second) {
+        length = std::max(length, chain_length.at(importer));
+      }
+    }
+    chain_length.emplace(*iter, length + 1);
+  }
+
+  auto lower_priority = [&](PathPtr lhs, PathPtr rhs) {
+    size_t lhs_length = chain_length.at(lhs);
+    size_t rhs_length = chain_length.at(rhs);
+    if (lhs_length != rhs_length) { return lhs_length < rhs_length; }
+    return order_.at(lhs) > order_.at(rhs);
+  };
+  std::priority_queue<PathPtr, std::vector<PathPtr>, decltype(lower_priority)>
+      ready(lower_priority);
+
+  base::unordered_map<PathPtr, size_t> num_unscheduled_imports;
+  for (auto path : topological) {
+    auto iter = import_deps_.find(path);
+    size_t num_imports = (iter == import_deps_.end()) ? 0 : iter->second.size();
+    num_unscheduled_imports.emplace(path, num_imports);
+    if (num_imports == 0) { ready.push(path); }
+  }
+
+  base::vector<PathPtr> schedule;
+  schedule.reserve(topological.size());
+  while (!ready.empty()) {
+    auto path = ready.top();
+    ready.pop();
+    schedule.push_back(path);
+
+    auto iter = importers_.find(path);
+    if (iter == importers_.end()) { continue; }
+    for (auto importer : iter->second) {
+      if (--num_unscheduled_imports.at(importer) == 0) { ready.push(importer); }
+    }
+  }
+  return schedule;
+}
+
+base::vector<std::filesystem::path const *>
+ImportGraph::WithTransitiveImporters(
+    base::vector<std::filesystem::path const *> const &paths) const {
+  std::unordered_set<PathPtr> handled(paths.begin(), paths.end());
+  base::vector<PathPtr> result(handled.begin(), handled.end());
+  for (size_t i = 0; i < result.size(); ++i) {
+    auto iter = importers_.find(result[i]);
+    if (iter == importers_.end()) { continue; }
+    for (auto importer : iter->second) {
+      if (handled.insert(importer).second) { result.push_back(importer); }
+    }
+  }
+  return result;
+}
+
+void ImportGraph::ClearDependencies(std::filesystem::path const *depender) {
+  // Removing edges never invalidates a topological order, so `order_` is left
+  // as is.
+  auto iter = import_deps_.find(depender);
+  if (iter == import_deps_.end()) { return; }
+  for (auto dependee : iter->second) { importers_.at(dependee).erase(depender); }
+  import_deps_.erase(iter);
 }
@@ -4,14 +4,44 @@
 #include <filesystem>
 #include <unordered_set>
 #include "base/container/unordered_map.h"
+#include "base/container/vector.h"
 
+// Tracks which source files import which others. Alongside the edges we
+// maintain a topological order of the nodes incrementally (Pearce-Kelly), so
+// adding an edge only ever touches the nodes whose relative order it affects
+// rather than searching the entire graph.
 struct ImportGraph {
  public:
   std::pair<std::filesystem::path const *, bool> node(
       std::filesystem::path const &p);
 
-  bool AddDependency(std::filesystem::path const *dependee,
-                     std::filesystem::path const *depender);
+  // Returns every path in the graph.
+  base::vector<std::filesystem::path const *> paths() const;
+
+  // Records that `depender` imports `dependee`. Returns an empty vector on
+  // success. If the dependency would introduce a cycle, it is not added and
+  // the returned vector holds the cycle, starting and ending at `depender`,
+  // with each path importing the one following it.
+  base::vector<std::filesystem::path const *> AddDependency(
+      std::filesystem::path const *dependee,
+      std::filesystem::path const *depender);
+
+  // Returns every path in the graph, each one appearing after everything it
+  // imports. Among the paths whose imports have all been scheduled, the one
+  // heading the longest chain of transitive importers comes first, as it
+  // gates the most downstream work.
+  base::vector<std::filesystem::path const *> CriticalPathSchedule() const;
+
+  // Returns `paths` along with every path which (transitively) imports any of
+  // them.
+  base::vector<std::filesystem::path const *> WithTransitiveImporters(
+      base::vector<std::filesystem::path const *> const &paths) const;
+
+  // Forgets every dependency recorded for `depender`, so that its imports can
+  // be recorded afresh when it is recompiled. Paths importing `depender` are
+  // unaffected.
+  void ClearDependencies(std::filesystem::path const *depender);
+
  private:
   struct PathHasher {
     size_t operator()(std::filesystem::path const &p) const {
@@ -20,9 +50,17 @@ struct ImportGraph {
   };
 
   std::unordered_set<std::filesystem::path, PathHasher> all_paths_;
+  // Maps each path to the paths it imports.
   base::unordered_map<std::filesystem::path const *,
                       std::unordered_set<std::filesystem::path const *>>
       import_deps_;
+  // Maps each path to the paths which import it.
+  base::unordered_map<std::filesystem::path const *,
+                      std::unordered_set<std::filesystem::path const *>>
+      importers_;
+  // Position of each path in a topological order of the graph. Every path is
+  // ordered after all of the paths it imports.
+  base::unordered_map<std::filesystem::path const *, size_t> order_;
 };
 
 #endif  // ICARUS_IMPORT_GRAPH_H
@@ -0,0 +1,154 @@
+#include "base/test.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+
+#include "import_graph.h"
+
+namespace {
+using PathPtr = std::filesystem::path const *;
+
+// Nodes must name files which exist, so each test creates empty ones.
+std::filesystem::path MakeFile(std::string const &name) {
+  auto dir = std::filesystem::temp_directory_path() / "import_graph_test";
+  std::filesystem::create_directories(dir);
+  auto path = dir / name;
+  std::ofstream{path};
+  return path;
+}
+
+// Returns whether every path in `schedule` appears after everything it imports
+// according to `imports`, and whether every path appears exactly once.
+bool IsTopological(base::vector<PathPtr> const &schedule,
+                   base::vector<std::pair<PathPtr, PathPtr>> const &imports,
+                   size_t num_paths) {
+  if (schedule.size() != num_paths) { return false; }
+  if (std::set<PathPtr>(schedule.begin(), schedule.end()).size() != num_paths) {
+    return false;
+  }
+  auto position = [&](PathPtr p) {
+    return std::find(schedule.begin(), schedule.end(), p) - schedule.begin();
+  };
+  for (auto[depender, dependee] : imports) {
+    if (position(depender) < position(dependee)) { return false; }
+  }
+  return true;
+}
+
+std::set<PathPtr> AsSet(base::vector<PathPtr> const &paths) {
+  return std::set<PathPtr>(paths.begin(), paths.end());
+}
+}  // namespace
+
+TEST(Node) {
+  ImportGraph graph;
+  auto[a, a_inserted] = graph.node(MakeFile("node_a.ic"));
+  EXPECT(a_inserted);
+  EXPECT(a != nullptr);
+
+  auto[a_again, a_again_inserted] = graph.node(MakeFile("node_a.ic"));
+  EXPECT(a_again == a);
+  EXPECT(!a_again_inserted);
+
+  auto[missing, missing_inserted] = graph.node(
+      std::filesystem::temp_directory_path() / "import_graph_test/nope.ic");
+  EXPECT(missing == nullptr);
+  EXPECT(!missing_inserted);
+  EXPECT(graph.paths().size() == size_t{1});
+}
+
+TEST(OrderAgainstInsertion) {
+  // Each path imports the one created before it, so every edge goes against
+  // the order the paths were first seen in, and each must be reordered.
+  ImportGraph graph;
+  base::vector<PathPtr> paths;
+  for (int i = 0; i < 6; ++i) {
+    auto name = "order_" + std::to_string(i) + ".ic";
+    paths.push_back(graph.node(MakeFile(name)).first);
+  }
+  base::vector<std::pair<PathPtr, PathPtr>> imports;
+  for (size_t i = 0; i + 1 < paths.size(); ++i) {
+    EXPECT(graph.AddDependency(paths[i + 1], paths[i]).empty());
+    imports.emplace_back(paths[i], paths[i + 1]);
+  }
+  EXPECT(IsTopological(graph.CriticalPathSchedule(), imports, paths.size()));
+
+  // An edge which agrees with the order already found changes nothing.
+  EXPECT(graph.AddDependency(paths[5], paths[0]).empty());
+  imports.emplace_back(paths[0], paths[5]);
+  EXPECT(IsTopological(graph.CriticalPathSchedule(), imports, paths.size()));
+
+  // Recording the same import twice is harmless.
+  EXPECT(graph.AddDependency(paths[5], paths[0]).empty());
+  EXPECT(IsTopological(graph.CriticalPathSchedule(), imports, paths.size()));
+}
+
+TEST(Cycle) {
+  ImportGraph graph;
+  auto a = graph.node(MakeFile("cycle_a.ic")).first;
+  auto b = graph.node(MakeFile("cycle_b.ic")).first;
+  auto c = graph.node(MakeFile("cycle_c.ic")).first;
+
+  EXPECT((graph.AddDependency(a, a) == base::vector<PathPtr>{a, a}));
+
+  // a imports b, which imports c.
+  EXPECT(graph.AddDependency(b, a).empty());
+  EXPECT(graph.AddDependency(c, b).empty());
+
+  // c importing a would close the cycle, which is reported starting and ending
+  // at c, each path importing the next.
+  EXPECT((graph.AddDependency(a, c) == base::vector<PathPtr>{c, a, b, c}));
+
+  // The rejected import is not recorded.
+  EXPECT((AsSet(graph.WithTransitiveImporters({a})) == std::set<PathPtr>{a}));
+  EXPECT(IsTopological(graph.CriticalPathSchedule(), {{a, b}, {b, c}}, 3));
+}
+
+TEST(CriticalPathSchedule) {
+  // x is imported by y, which is imported by z. w stands alone, and was seen
+  // first.
+  ImportGraph graph;
+  auto w = graph.node(MakeFile("critical_w.ic")).first;
+  auto x = graph.node(MakeFile("critical_x.ic")).first;
+  auto y = graph.node(MakeFile("critical_y.ic")).first;
+  auto z = graph.node(MakeFile("critical_z.ic")).first;
+  EXPECT(graph.AddDependency(x, y).empty());
+  EXPECT(graph.AddDependency(y, z).empty());
+
+  // x heads the longest chain of importers, so it comes before w even though
+  // w was seen first. Once it is scheduled, y heads the longest chain.
+  auto schedule = graph.CriticalPathSchedule();
+  EXPECT(IsTopological(schedule, {{y, x}, {z, y}}, 4));
+  EXPECT(schedule.at(0) == x);
+  EXPECT(schedule.at(1) == y);
+  EXPECT(schedule.at(2) == w || schedule.at(3) == w);
+}
+
+TEST(TransitiveImporters) {
+  ImportGraph graph;
+  auto a = graph.node(MakeFile("importers_a.ic")).first;
+  auto b = graph.node(MakeFile("importers_b.ic")).first;
+  auto c = graph.node(MakeFile("importers_c.ic")).first;
+  auto d = graph.node(MakeFile("importers_d.ic")).first;
+  // b and c import a. d imports c.
+  EXPECT(graph.AddDependency(a, b).empty());
+  EXPECT(graph.AddDependency(a, c).empty());
+  EXPECT(graph.AddDependency(c, d).empty());
+
+  EXPECT((AsSet(graph.WithTransitiveImporters({a})) ==
+          std::set<PathPtr>{a, b, c, d}));
+  EXPECT((AsSet(graph.WithTransitiveImporters({c})) == std::set<PathPtr>{c, d}));
+  EXPECT((AsSet(graph.WithTransitiveImporters({b, d})) ==
+          std::set<PathPtr>{b, d}));
+
+  // Once c's imports are forgotten, a change to a no longer reaches c or d.
+  graph.ClearDependencies(c);
+  EXPECT((AsSet(graph.WithTransitiveImporters({a})) ==
+          std::set<PathPtr>{a, b}));
+
+  // Nor does anything stop a from importing c now.
+  EXPECT(graph.AddDependency(c, a).empty());
+}
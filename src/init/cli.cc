@@ -80,6 +80,8 @@ int ShowUsage() {
   constexpr int terminal_width = 80;
   int max_name_length          = 0;
   for (const auto & [ name, handler ] : ::cli::internal::all_handlers) {
+    // Flags registered without a description are hidden.
+    if (handler->msg_.empty()) { continue; }
     handlers[handler].push_back(name);
     max_name_length = std::max<int>(max_name_length, name.size());
   }
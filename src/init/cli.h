@@ -48,6 +48,29 @@ struct Handler {
           return ::cli::internal::Result::ParseError;
         }
       };
+    } else if constexpr (std::is_invocable_v<Fn, char const *>) {
+      parse_and_apply_ = [ this, f = std::forward<Fn>(fn) ](char const *arg) {
+        bool called_already = called_;
+        called_             = true;
+        if (call_once_ && called_already) {
+          return ::cli::internal::Result::AlreadyCalled;
+        }
+
+        if (arg == nullptr) {
+          // Flags taking a value must be passed as "--flag=value".
+          return ::cli::internal::Result::ParseError;
+        } else if (strcmp("", arg) == 0) {
+          if constexpr (std::is_invocable_v<Fn>) {
+            f();
+            return ::cli::internal::Result::Ok;
+          } else {
+            return ::cli::internal::Result::ParseError;
+          }
+        } else {
+          f(arg);
+          return ::cli::internal::Result::Ok;
+        }
+      };
     } else if constexpr (std::is_invocable_v<Fn>) {
       call_once_       = false;
       parse_and_apply_ = [ this, f = std::forward<Fn>(fn) ](char const *) {
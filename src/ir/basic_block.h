@@ -32,6 +32,7 @@ struct BasicBlock {
   std::list<Arguments> arguments_;
   std::list<OutParams> outs_;
   std::vector<std::unique_ptr<GenericPhiArgs>> phi_args_;
+  std::vector<std::unique_ptr<TypeJumpTable>> jump_tables_;
 };
 
 inline std::ostream &operator<<(std::ostream &os, BasicBlock const &b) {
@@ -9,6 +9,7 @@
 #include "ir/func.h"
 #include "ir/phi.h"
 #include "ir/val.h"
+#include "time_passes.h"
 #include "type/all.h"
 #include "type/typed_value.h"
 
@@ -32,6 +33,7 @@ void Destroy(type::Type const *t, Register r) {
 }
 
 Cmd &MakeCmd(type::Type const *t, Op op) {
+  time_passes::Count(time_passes::Counter::Cmds);
   auto &cmd = ASSERT_NOT_NULL(Func::Current)
                   ->block(BasicBlock::Current)
                   .cmds_.emplace_back(t, op);
@@ -420,6 +422,7 @@ void AddHashtagToStruct(Register struct_type, ast::Hashtag hashtag) {
 }
 
 TypedRegister<Addr> Alloca(type::Type const *t) {
+  time_passes::Count(time_passes::Counter::Cmds);
   auto &cmd = ASSERT_NOT_NULL(Func::Current)
                   ->block(Func::Current->entry())
                   .cmds_.emplace_back(type::Ptr(t), Op::Alloca);
@@ -597,6 +600,22 @@ void BlockSeqJump(RegisterOr<BlockSequence> bseq,
   cmd.block_seq_jump_ = Cmd::BlockSeqJump{bseq, jump_table};
 }
 
+void TypeJump(RegisterOr<type::Type const *> type, TypeJumpTable jump_table) {
+  if (!type.is_reg_) {
+    auto iter = std::find_if(
+        jump_table.begin(), jump_table.end(),
+        [&](auto const &entry) { return entry.first == type.val_; });
+    ASSERT(iter != jump_table.end());
+    UncondJump(iter->second);
+    return;
+  }
+  auto &block = ir::Func::Current->block(ir::BasicBlock::Current);
+  auto &table = *block.jump_tables_.emplace_back(
+      std::make_unique<TypeJumpTable>(std::move(jump_table)));
+  auto &cmd      = MakeCmd(nullptr, Op::TypeJump);
+  cmd.type_jump_ = Cmd::TypeJump{type.reg_, &table};
+}
+
 template <typename T>
 static std::ostream &operator<<(std::ostream &os,
                                 std::array<RegisterOr<T>, 2> r) {
@@ -663,6 +682,14 @@ static std::ostream &operator<<(std::ostream &os, Cmd::BlockSeqJump const &b) {
   return os << b.bseq_;
 }
 
+static std::ostream &operator<<(std::ostream &os, Cmd::TypeJump const &j) {
+  os << j.type_;
+  for (auto const & [ t, block ] : *j.jump_table_) {
+    os << " " << t->to_string() << " -> " << block;
+  }
+  return os;
+}
+
 static std::ostream &operator<<(std::ostream &os,
                                 Cmd::BlockSeqContains const &b) {
   return os << b.lit_;
@@ -43,6 +43,10 @@ struct PhiArgs : GenericPhiArgs {
   std::unordered_map<BlockIndex, RegisterOr<T>> map_;
 };
 
+// The block to jump to for each type a `TypeJump` may see. Entries are tested
+// in order.
+using TypeJumpTable = base::vector<std::pair<type::Type const *, BlockIndex>>;
+
 struct Cmd {
   template <typename T>
   struct Store {
@@ -190,6 +194,12 @@ struct Cmd {
         *jump_table_;
   };
 
+  // Jumps to the block `jump_table_` pairs with the type in `type_`.
+  struct TypeJump {
+    Register type_;
+    TypeJumpTable const *jump_table_;
+  };
+
   struct LoadSymbol {
     std::string_view name_;
     type::Type const *type_;
@@ -234,6 +244,7 @@ struct Cmd {
     CondJump cond_jump_;
     BlockIndex block_;
     BlockSeqJump block_seq_jump_;
+    TypeJump type_jump_;
     Call call_;
     PtrIncr ptr_incr_;
     BlockSeqContains block_seq_contains_;
@@ -564,6 +575,11 @@ void BlockSeqJump(RegisterOr<BlockSequence> r,
                   std::unordered_map<ast::BlockLiteral const *,
                                      ir::BlockIndex> const *jump_table);
 
+// Jumps to the block `jump_table` pairs with `type`. The table must have an
+// entry for every type `type` may hold. Entries are tested in order, so a
+// branch profile may reorder them. See `backend::Profile::Apply`.
+void TypeJump(RegisterOr<type::Type const *> type, TypeJumpTable jump_table);
+
 RegisterOr<bool> BlockSeqContains(RegisterOr<BlockSequence> r,
                                   ast::BlockLiteral *lit);
 
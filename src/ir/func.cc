@@ -5,6 +5,7 @@
 #include "ir/arguments.h"
 #include "property/property.h"
 #include "property/property_map.h"
+#include "time_passes.h"
 #include "type/function.h"
 #include "type/pointer.h"
 
@@ -23,6 +24,7 @@ Func::Func(Module *mod, type::Function const *fn_type,
       params_(std::move(params)),
       num_regs_(static_cast<i32>(type_->input.size() + type_->output.size())),
       mod_(mod) {
+  time_passes::Count(time_passes::Counter::IrFuncs);
   // Set the references for arguments and returns
   for (i32 i = -static_cast<i32>(type_->output.size());
        i < static_cast<i32>(type_->input.size()); ++i) {
@@ -66,6 +68,11 @@ Func::GetIncomingBlocks() const {
         incoming[&block(last.cond_jump_.blocks_[0])].insert(&b);
         incoming[&block(last.cond_jump_.blocks_[1])].insert(&b);
         break;
+      case Op::TypeJump:
+        for (auto const & [ t, block ] : *last.type_jump_.jump_table_) {
+          incoming[&this->block(block)].insert(&b);
+        }
+        break;
       case Op::ReturnJump: /* Nothing to do */ break;
       default: UNREACHABLE(ir::OpCodeStr(last.op_code_));
     }
@@ -79,10 +86,9 @@ Cmd const *Func::Command(Register reg) const {
   return &Command(iter->second);
 }
 
-static base::vector<std::pair<ir::Func, prop::PropertyMap>> InvariantsFor(
+static std::deque<std::pair<ir::Func, prop::PropertyMap>> InvariantsFor(
     ir::Func *fn, base::vector<ast::Expression *> const &exprs) {
-  base::vector<std::pair<ir::Func, prop::PropertyMap>> result;
-  // Resreve to guarantee pointer stability.
+  std::deque<std::pair<ir::Func, prop::PropertyMap>> result;
   for (auto const &expr : exprs) {
     auto & [ func, prop_map ] = result.emplace_back(
         std::piecewise_construct,
@@ -1,6 +1,8 @@
 #ifndef ICARUS_IR_FUNC_H
 #define ICARUS_IR_FUNC_H
 
+#include <atomic>
+#include <deque>
 #include <unordered_set>
 
 #include "ast/fn_params.h"
@@ -21,6 +23,7 @@ struct Function;
 }  // namespace type
 
 struct Module;
+struct TextSpan;
 
 namespace ir {
 struct CmdIndex {
@@ -87,18 +90,28 @@ struct Func {
   i32 num_regs_  = 0;
   i32 neg_bound_ = 0;
   base::vector<BasicBlock> blocks_;
-  Module::CompilationWorkItem *work_item = nullptr;
+  // Non-null until the function's body has been completed. Atomic because
+  // bodies skipped over by a lazy parse may be completed from any thread. See
+  // `Module::CompleteFunc`.
+  std::atomic<Module::CompilationWorkItem *> work_item = nullptr;
+  // Set if completing the body logged errors, in which case the function is
+  // never executed. See `backend::Execute`.
+  std::atomic<bool> has_errors_ = false;
 #ifdef ICARUS_USE_LLVM
   llvm::Function *llvm_fn_ = nullptr;
 #endif  // ICARUS_USE_LLVM
 
   Module *mod_;
+  // Where the function was declared, if it was emitted from a function
+  // literal. Identifies it across compilations, for branch profiles.
+  TextSpan const *span_ = nullptr;
 
   size_t reg_size_ = 0;
   base::unordered_map<i32, Register> reg_map_;
 
   base::vector<ast::Expression *> precondition_exprs_, postcondition_exprs_;
-  base::vector<std::pair<ir::Func, prop::PropertyMap>> preconditions_,
+  // Deques, since each property map points at the function beside it.
+  std::deque<std::pair<ir::Func, prop::PropertyMap>> preconditions_,
       postconditions_;
   base::unordered_map<Register, base::bag<Register>> references_;
   base::unordered_map<Register, CmdIndex> reg_to_cmd_;
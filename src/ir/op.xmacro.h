@@ -221,6 +221,7 @@ OP_MACRO(CondJump,             Jump,                bool,                    con
 OP_MACRO(UncondJump,           Jump,                void,                    block_)
 OP_MACRO(ReturnJump,           Jump,                i32,  /* any tag */      empty_)
 OP_MACRO(BlockSeqJump,         Jump,                BlockSequence,           block_seq_jump_)
+OP_MACRO(TypeJump,             Jump,                type::Type const*,       type_jump_)
 OP_MACRO(VariantType,          VariantType,         void,                    addr_arg_)
 OP_MACRO(VariantValue,         VariantValue,        void,                    addr_arg_)
 OP_MACRO(Call,                 Call,                void,                    call_)
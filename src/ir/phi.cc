@@ -1,5 +1,6 @@
 #include "ir/phi.h"
 
+#include "time_passes.h"
 #include "type/enum.h"
 #include "type/flags.h"
 #include "type/function.h"
@@ -33,6 +34,7 @@ CmdIndex Phi(type::Type const *t) {
   CmdIndex cmd_index{
       BasicBlock::Current,
       static_cast<i32>(Func::Current->block(BasicBlock::Current).cmds_.size())};
+  time_passes::Count(time_passes::Counter::Cmds);
   ASSERT_NOT_NULL(Func::Current)
       ->block(BasicBlock::Current)
       .cmds_.emplace_back(t, Op::Death);
@@ -3,10 +3,10 @@
 #include <sstream>
 #include <unordered_set>
 
-#include "architecture.h"
 #include "ast/block_literal.h"
 #include "ast/function_literal.h"
 #include "ast/scope_literal.h"
+#include "base/arena.h"
 #include "base/guarded.h"
 #include "ir/func.h"
 #include "type/enum.h"
@@ -15,10 +15,6 @@
 #include "type/pointer.h"
 #include "type/struct.h"
 
-namespace backend {
-extern base::untyped_buffer ReadOnlyData;
-}  // namespace backend
-
 namespace ir {
 
 // TODO this stores way more than is needed. It'd be nice to have a way to say
@@ -42,25 +38,34 @@ BlockSequence MakeBlockSeq(const base::vector<ir::BlockSequence> &blocks) {
   return BlockSequence{&*iter};
 }
 
-// TODO avoid double-storing the string.
-static base::guarded<std::unordered_map<std::string, Addr>> GlobalStringSet;
-std::string_view SaveStringGlobally(std::string const &str) {
-  auto handle         = GlobalStringSet.lock();
-  auto[iter, success] = handle->emplace(str, Addr::ReadOnly(0));
-  if (!success) { return iter->first; }
-
-  size_t buf_end = backend::ReadOnlyData.size();
-  backend::ReadOnlyData.append_bytes(
-      str.size() + 1,  // +1 for the null terminator.
-      Architecture::InterprettingMachine().alignment(type::Nat8));
-  std::memcpy(backend::ReadOnlyData.raw(buf_end), str.data(), str.size() + 1);
-  iter->second = Addr::ReadOnly(buf_end);
-
-  return iter->first;
+namespace {
+// Every interned string is copied once into `storage_`, which never moves it.
+// The views handed out and the addresses the interpreter reads through both
+// point at that one copy.
+struct StringSet {
+  base::Arena storage_;
+  std::unordered_set<std::string_view> strings_;
+};
+base::guarded<StringSet> global_strings;
+}  // namespace
+
+std::string_view SaveStringGlobally(std::string_view str) {
+  auto handle = global_strings.lock();
+  if (auto iter = handle->strings_.find(str); iter != handle->strings_.end()) {
+    return *iter;
+  }
+
+  auto *data = static_cast<char *>(handle->storage_.Allocate(str.size() + 1));
+  std::memcpy(data, str.data(), str.size());
+  data[str.size()] = '\0';  // So that it can be passed to foreign functions.
+  return *handle->strings_.emplace(data, str.size()).first;
 }
 
-Addr GetString(std::string const &str) {
-  return GlobalStringSet.lock()->find(str)->second;
+Addr GetString(std::string_view str) {
+  auto handle = global_strings.lock();
+  auto iter   = handle->strings_.find(str);
+  ASSERT(iter != handle->strings_.end());
+  return Addr::Heap(const_cast<char *>(iter->data()));
 }
 
 Val Val::BlockSeq(BlockSequence b) {
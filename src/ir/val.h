@@ -34,7 +34,10 @@ struct FunctionLiteral;
 }  // namespace ast
 
 namespace ir {
-std::string_view SaveStringGlobally(std::string const &str);
+// Copies `str` into the program's string store, unless an equal string is
+// already there, and returns a view of the stored copy. It lives as long as
+// the program and is null-terminated. See `GetString` for its address.
+std::string_view SaveStringGlobally(std::string_view str);
 
 struct Val {
   const type::Type *type = nullptr;
@@ -65,10 +68,8 @@ struct Val {
     } else if constexpr (IsTypedReg<decayed>::value) {
       type = ::type::Get<typename decayed::type>();
       value = static_cast<Register>(val);
-    } else if constexpr (std::is_same_v<decayed, std::string_view>) {
-      type  = ::type::ByteView;
-      value = SaveStringGlobally(std::string(val));
-    } else if constexpr (std::is_same_v<decayed, std::string>) {
+    } else if constexpr (std::is_same_v<decayed, std::string_view> ||
+                         std::is_same_v<decayed, std::string>) {
       type  = ::type::ByteView;
       value = SaveStringGlobally(val);
     } else {
@@ -126,7 +127,9 @@ inline bool operator==(const Val &lhs, const Val &rhs) {
 inline bool operator!=(const Val &lhs, const Val &rhs) { return !(lhs == rhs); }
 bool operator<(const ::ir::Val &lhs, const ::ir::Val &rhs);
 
-Addr GetString(std::string const &str);
+// Returns the address at which the interpreter finds `str`, which must have
+// been saved by `SaveStringGlobally`.
+Addr GetString(std::string_view str);
 
 }  // namespace ir
 
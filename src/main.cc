@@ -1,27 +1,45 @@
+#include <cstdlib>
+
 #include "base/container/vector.h"
+#include "base/trace.h"
 #include "frontend/source.h"
 #include "init/cli.h"
 #include "init/signal.h"
+#include "time_passes.h"
 
 namespace debug {
 bool parser     = false;
 bool validation = false;
+// If nonzero, override the number of threads used to verify a module's
+// top-level declarations, and the number of declarations a module needs before
+// they are verified in parallel.
+size_t parallel_threads   = 0;
+size_t parallel_min_decls = 0;
 }  // namespace debug
 
 namespace feature {
-bool loose_casting = false;
+bool loose_casting        = false;
+bool lazy_function_bodies = false;
 }  // namespace feature
 
+static char const *trace_output = nullptr;
+
 extern base::vector<frontend::Source::Name> files;
 
 int RunRepl();
 int RunCompiler();
+int RunServer();
+int RunWatch();
+
+extern char const *server_socket;
 
-#ifdef ICARUS_USE_LLVM
 namespace backend {
+#ifdef ICARUS_USE_LLVM
 extern char const *output_file;
-}  // namespace backend
 #endif
+extern char const *profile_output;
+extern char const *profile_input;
+}  // namespace backend
 
 void cli::Usage() {
   Flag("help") << "Show usage information."
@@ -33,6 +51,14 @@ void cli::Usage() {
          "loss of precision."
       << [](bool b = false) { feature::loose_casting = b; };
 
+#ifndef ICARUS_USE_LLVM
+  Flag("lazy-function-bodies")
+      << "Skip over the bodies of functions in imported modules when parsing, "
+         "and only parse and verify those which are called. Errors in the "
+         "bodies of functions which are never called are not reported."
+      << [](bool b = false) { feature::lazy_function_bodies = b; };
+#endif  // ICARUS_USE_LLVM
+
 #ifdef DBG
   Flag("debug-parser") << "Step through the parser step-by-step for debugging."
                        << [](bool b = false) { debug::parser = b; };
@@ -44,8 +70,67 @@ void cli::Usage() {
 #ifdef ICARUS_USE_LLVM
   Flag("output") << "The name of the output file to write." <<
       [](char const *out = "a.out") { backend::output_file = out; };
+#else
+  Flag("profile-generate")
+      << "Count how often each branch is taken while running the program, and "
+         "write the counts to the given path."
+      << [](char const *path = nullptr) { backend::profile_output = path; };
+
+  Flag("profile-use")
+      << "Read a branch profile written by --profile-generate from the given "
+         "path, and test the likeliest cases of each variant dispatch first."
+      << [](char const *path = nullptr) { backend::profile_input = path; };
 #endif
 
+  // Hidden, so that tests can exercise parallel verification on any machine and
+  // on small modules.
+  Flag("parallel-threads") << [](char const *n = "0") {
+    debug::parallel_threads = std::strtoull(n, nullptr, 10);
+  };
+  Flag("parallel-min-decls") << [](char const *n = "0") {
+    debug::parallel_min_decls = std::strtoull(n, nullptr, 10);
+  };
+
+  Flag("server")
+      << "Run as a persistent compile server, listening for requests on the "
+         "Unix domain socket at the given path."
+      << [](char const *path = nullptr) {
+           if (path == nullptr) { return; }
+           server_socket = path;
+           execute       = RunServer;
+         };
+
+  Flag("watch")
+      << "Compile and run, then watch every imported source file, recompiling "
+         "only what changed and re-running whenever any of them is modified."
+      << [](bool b = false) {
+           if (b) { execute = RunWatch; }
+         };
+
+  Flag("time-passes")
+      << "Report the wall and CPU time spent in each compilation phase of each "
+         "module, along with counts of the work done, when exiting."
+      << [](bool b = false) { time_passes::enabled |= b; };
+
+  Flag("time-passes-json")
+      << "Also write the report produced by --time-passes to the given path "
+         "as JSON. Implies --time-passes."
+      << [](char const *path = nullptr) {
+           if (path == nullptr) { return; }
+           time_passes::json_output = path;
+           time_passes::enabled     = true;
+         };
+
+  Flag("trace")
+      << "Write a Chrome trace-event file to the given path on exit, showing "
+         "the compilation phases of each module, compile-time evaluations, "
+         "and time spent waiting on locks and imports."
+      << [](char const *path = nullptr) {
+           if (path == nullptr) { return; }
+           trace_output         = path;
+           base::trace::enabled = true;
+         };
+
   Flag("repl", "r") << "Run the read-eval-print-loop." << [](bool b = false) {
     if (!execute) { execute = (b ? RunRepl : RunCompiler); }
   };
@@ -55,5 +140,8 @@ void cli::Usage() {
 
 int main(int argc, char *argv[]) {
   init::InstallSignalHandlers();
-  return cli::ParseAndRun(argc, argv);
+  int result = cli::ParseAndRun(argc, argv);
+  time_passes::Report();
+  if (trace_output != nullptr) { base::trace::Write(trace_output); }
+  return result;
 }
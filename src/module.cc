@@ -1,17 +1,23 @@
 #include "module.h"
 
+#include <atomic>
 #include <list>
+#include <thread>
 
 #include "ast/declaration.h"
 #include "ast/expression.h"
 #include "ast/function_literal.h"
+#include "ast/instantiations.h"
 #include "ast/struct_literal.h"
 #include "backend/emit.h"
 #include "backend/eval.h"
+#include "backend/profile.h"
 #include "base/guarded.h"
+#include "base/trace.h"
 #include "frontend/source.h"
 #include "import_graph.h"
 #include "ir/func.h"
+#include "time_passes.h"
 #include "type/function.h"
 
 #ifdef ICARUS_USE_LLVM
@@ -35,6 +41,15 @@ static base::unordered_map<
 std::atomic<bool> found_errors = false;
 ir::Func *main_fn;
 
+namespace debug {
+extern size_t parallel_threads;
+extern size_t parallel_min_decls;
+}  // namespace debug
+
+namespace feature {
+extern bool lazy_function_bodies;
+}  // namespace feature
+
 // Can't declare this in header because unique_ptr's destructor needs to know
 // the size of ir::Func which we want to forward declare.
 Module::Module()
@@ -47,7 +62,10 @@ Module::Module()
 {
   global_->module_ = this;
 }
-Module::~Module() = default;
+Module::~Module() {
+  ast::ForgetInstantiations(this);
+  ast::ForgetBoundConstants(this);
+}
 
 ir::Func *Module::AddFunc(type::Function const *fn_type,
                           ast::FnParams<ast::Expression *> params) {
@@ -65,24 +83,35 @@ ir::Func *Module::AddFunc(type::Function const *fn_type,
   return result;
 }
 
-type::Type const *Module::GetType(std::string const &name) const {
-  ASSIGN_OR(return nullptr, auto &decl, GetDecl(name));
-  return data_.at(ast::BoundConstants{}).types_.at(&decl);
+type::Type const *Module::GetType(Symbol name) const {
+  auto const &exports = GetExports(name);
+  return exports.empty() ? nullptr : exports.front().type();
+}
+
+ast::Declaration *Module::GetDecl(Symbol name) const {
+  auto const &exports = GetExports(name);
+  return exports.empty() ? nullptr : exports.front().get();
 }
 
-ast::Declaration *Module::GetDecl(std::string const &name) const {
+base::vector<type::Typed<ast::Declaration *>> const &Module::GetExports(
+    Symbol name) const {
+  static base::vector<type::Typed<ast::Declaration *>> const kNoExports;
+  auto iter = exports_.find(name);
+  return iter == exports_.end() ? kNoExports : iter->second;
+}
+
+void Module::IndexExports() {
   for (auto const &stmt : statements_.content_) {
     ASSIGN_OR(continue, auto &decl, stmt->if_as<ast::Declaration>());
-    if (decl.id_ != name) { continue; }
     auto &hashtags = decl.hashtags_;
     bool exported =
         std::any_of(hashtags.begin(), hashtags.end(), [](ast::Hashtag h) {
           return h.kind_ == ast::Hashtag::Builtin::Export;
         });
     if (!exported) { continue; }
-    return &decl;
+    exports_[decl.id_].emplace_back(
+        &decl, ASSERT_NOT_NULL(type_of(ast::BoundConstants{}, &decl)));
   }
-  return nullptr;
 }
 
 Module::CompilationWorkItem::CompilationWorkItem(ast::BoundConstants bc,
@@ -91,9 +120,10 @@ Module::CompilationWorkItem::CompilationWorkItem(ast::BoundConstants bc,
     : bound_constants_(std::move(bc)), expr_(e), mod_(mod) {}
 
 void Module::CompilationWorkItem::Complete() {
+  std::lock_guard lock(mod_->completion_mtx_);
   // Need to copy bc because this needs to be set before we call CompleteBody.
   // TODO perhaps on ctx it could be a pointer?
-  if (mod_->completed_[bound_constants_].emplace(expr_).second) {
+  if (mod_->completed_[bound_constants_.id()].emplace(expr_).second) {
     Context ctx(mod_);
     ctx.bound_constants_ = bound_constants_;
     if (expr_->is<ast::FunctionLiteral>()) {
@@ -112,42 +142,215 @@ void Module::CompilationWorkItem::Complete() {
   }
 }
 
+void Module::CompleteFunc(ir::Func *fn) {
+  auto *item = fn->work_item.load();
+  if (item == nullptr) { return; }
+  std::lock_guard lock(item->mod_->completion_mtx_);
+  // Another thread may have completed it while we waited.
+  if (fn->work_item.load() != item) { return; }
+  item->Complete();
+  if (backend::active_profile != nullptr) { backend::active_profile->Apply(fn); }
+  // The function may belong to a module whose invariants have already been
+  // computed without its body.
+  fn->ComputeInvariants();
+  fn->work_item = nullptr;
+}
+
+// Completes every function called from `fn` whose body has not been parsed
+// yet, along with everything those functions call in turn.
+static void CompleteCallees(ir::Func *fn) {
+  base::vector<ir::Func *> to_scan = {fn};
+  while (!to_scan.empty()) {
+    auto *caller = to_scan.back();
+    to_scan.pop_back();
+    for (auto const &block : caller->blocks_) {
+      for (auto const &cmd : block.cmds_) {
+        if (cmd.op_code_ != ir::Op::Call) { continue; }
+        if (cmd.call_.fn_.is_reg_ || !cmd.call_.fn_.val_.is_fn()) { continue; }
+        auto *callee = cmd.call_.fn_.val_.func();
+        if (callee->work_item == nullptr) { continue; }
+        Module::CompleteFunc(callee);
+        to_scan.push_back(callee);
+      }
+    }
+  }
+}
+
 void Module::CompleteAll() {
+  base::vector<ir::Func *> completed_fns;
   while (!to_complete_.empty()) {
-    to_complete_.front().Complete();
+    auto &item = to_complete_.front();
+    auto *fn_lit = item.expr_->if_as<ast::FunctionLiteral>();
+    if (fn_lit != nullptr) {
+      auto *ir_func = ASSERT_NOT_NULL(find_data(item.bound_constants_))
+                          ->ir_funcs_.at(fn_lit);
+      if (fn_lit->unparsed_body_ && ir_func->work_item == &item) {
+        ir_func->work_item = &deferred_.emplace_back(std::move(item));
+        to_complete_.pop();
+        continue;
+      }
+      completed_fns.push_back(ir_func);
+      item.Complete();
+      ir_func->work_item = nullptr;
+    } else {
+      item.Complete();
+    }
     to_complete_.pop();
   }
+
+  if (feature::lazy_function_bodies) {
+    for (auto *fn : completed_fns) { CompleteCallees(fn); }
+  }
 }
 
-// Once this function exits the file is destructed and we no longer have
-// access to the source lines. All verification for this module must be done
-// inside this function.
-static Module const *CompileModule(Module *mod) {
+// Modules with fewer top-level declarations than this are always verified on a
+// single thread.
+constexpr size_t kMinParallelDecls = 64;
+
+static bool IsNamedDecl(ast::Node const *node) {
+  auto *decl = node->if_as<ast::Declaration>();
+  return decl != nullptr && !decl->id_.empty();
+}
+
+// Runs `phase` on the statements in [`begin`, `end`), which must all be named
+// declarations, on up to `num_threads` threads. Each is run with its own
+// context and with its declaration claimed, so the declarations it depends on
+// are run by whichever thread needs them first, as they would be serially.
+// Once one logs an error no more are started, since what those after it log
+// depends on it, and the rest are run on this thread afterwards with `ctx`.
+// Errors are appended to `ctx` in statement order.
+static void RunDeclsInParallel(Module *mod, ast::Statements *stmts,
+                               size_t begin, size_t end, size_t num_threads,
+                               void (*phase)(ast::Node *, Context *),
+                               Context *ctx) {
+  mod->claims_ = std::make_unique<base::ClaimGroup>();
+  for (size_t i = begin; i < end; ++i) {
+    auto &decl = stmts->content_[i]->as<ast::Declaration>();
+    auto *part = mod->claims_->AddPart();
+    mod->claim_parts_.emplace(&decl, part);
+    if (decl.init_val != nullptr && decl.init_val->is<ast::FunctionLiteral>()) {
+      mod->claim_parts_.emplace(decl.init_val.get(), part);
+    }
+  }
+
+  struct StmtResult {
+    error::Log log_;
+    bool run_ = false;
+  };
+  base::vector<StmtResult> results(end - begin);
+  std::atomic<bool> any_errors = false;
+  auto work = [&] {
+    mod->claims_->Join();
+    size_t i;
+    while ((i = mod->claims_->TakeNext()) < results.size()) {
+      if (any_errors) { continue; }
+      Context stmt_ctx(mod);
+      stmt_ctx.defer_dump_ = true;
+      phase(stmts->content_[begin + i].get(), &stmt_ctx);
+      if (stmt_ctx.num_errors() != 0) { any_errors = true; }
+      results[i].log_ = std::move(stmt_ctx.error_log_);
+      results[i].run_ = true;
+    }
+    mod->claims_->Leave();
+  };
+
+  base::vector<std::future<void>> futures;
+  size_t num_helpers = std::min(num_threads, results.size()) - 1;
+  futures.reserve(num_helpers);
+  for (size_t i = 0; i < num_helpers; ++i) {
+    futures.push_back(std::async(std::launch::async, work));
+  }
+  work();
+  for (auto &f : futures) { f.get(); }
+  mod->claims_.reset();
+  mod->claim_parts_.clear();
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    if (results[i].run_) {
+      ctx->error_log_.Append(std::move(results[i].log_));
+    } else {
+      phase(stmts->content_[begin + i].get(), ctx);
+    }
+  }
+}
+
+// Runs `phase` on every top-level statement in `stmts`, as running it on
+// `stmts` itself would. In modules with enough declarations to be worth it,
+// the named declarations between other statements (such as imports) are run
+// in parallel.
+static void RunPhase(Module *mod, ast::Statements *stmts, Context *ctx,
+                     void (*phase)(ast::Node *, Context *)) {
+  auto const &content = stmts->content_;
+  size_t num_threads  = debug::parallel_threads != 0
+                           ? debug::parallel_threads
+                           : std::thread::hardware_concurrency();
+  size_t min_decls    = debug::parallel_min_decls != 0
+                         ? debug::parallel_min_decls
+                         : kMinParallelDecls;
+  size_t num_decls =
+      std::count_if(content.begin(), content.end(),
+                    [](auto const &stmt) { return IsNamedDecl(stmt.get()); });
+  bool parallel = num_threads > 1 && num_decls >= min_decls;
+
+  size_t i = 0;
+  while (i < content.size()) {
+    if (!parallel || ctx->num_errors() != 0 ||
+        !IsNamedDecl(content[i].get())) {
+      phase(content[i].get(), ctx);
+      ++i;
+      continue;
+    }
+
+    size_t end = i + 1;
+    while (end < content.size() && IsNamedDecl(content[end].get())) { ++end; }
+    RunDeclsInParallel(mod, stmts, i, end, num_threads, phase, ctx);
+    i = end;
+  }
+}
+
+// All verification for this module must be done inside this function, other
+// than of function bodies skipped over by a lazy parse, which are verified when
+// they are first needed.
+static Module const *CompileSource(Module *mod) {
   ast::BoundConstants bc;
   Context ctx(mod);
-  frontend::File f(ASSERT_NOT_NULL(mod->path_)->string());
-  auto file_stmts = f.Parse(&ctx);
+  base::trace::Span span("module", ASSERT_NOT_NULL(mod->path_)->string());
+  time_passes::PhaseTimer timer(mod->path_->string());
+  timer.Start(time_passes::Phase::Parse);
+  mod->source_ = std::make_unique<frontend::File>(mod->path_->string());
+  auto file_stmts = [&] {
+    ast::NodeArenaScope arena_scope(&mod->ast_arenas_.emplace_back());
+    return mod->source_->Parse(&ctx);
+  }();
+  mod->source_mtime_ = mod->source_->mtime;
+  mod->source_hash_  = mod->source_->content_hash;
   if (ctx.num_errors() > 0) {
     ctx.DumpErrors();
     found_errors = true;
     return mod;
   }
 
+  timer.Start(time_passes::Phase::AssignScope);
   file_stmts->assign_scope(ctx.mod_->global_.get());
-  file_stmts->VerifyType(&ctx);
+  timer.Start(time_passes::Phase::VerifyType);
+  RunPhase(mod, file_stmts.get(), &ctx,
+           [](ast::Node *n, Context *c) { n->VerifyType(c); });
   if (ctx.num_errors() != 0) {
     ctx.DumpErrors();
     found_errors = true;
     return mod;
   }
 
-  file_stmts->Validate(&ctx);
+  timer.Start(time_passes::Phase::Validate);
+  RunPhase(mod, file_stmts.get(), &ctx,
+           [](ast::Node *n, Context *c) { n->Validate(c); });
   if (ctx.num_errors() != 0) {
     ctx.DumpErrors();
     found_errors = true;
     return mod;
   }
 
+  timer.Start(time_passes::Phase::EmitIR);
   file_stmts->EmitIR(&ctx);
   if (ctx.num_errors() != 0) {
     ctx.DumpErrors();
@@ -156,6 +359,8 @@ static Module const *CompileModule(Module *mod) {
   }
 
   ctx.mod_->statements_ = std::move(*file_stmts);
+  ctx.mod_->IndexExports();
+  timer.Start(time_passes::Phase::CompleteAll);
   ctx.mod_->CompleteAll();
 
   if (ctx.num_errors() != 0) {
@@ -164,11 +369,33 @@ static Module const *CompileModule(Module *mod) {
     return mod;
   }
 
+  if (backend::active_profile != nullptr) {
+    for (auto &fn : ctx.mod_->fns_) { backend::active_profile->Apply(fn.get()); }
+  }
+
+  timer.Start(time_passes::Phase::ComputeInvariants);
   for (auto &fn : ctx.mod_->fns_) { fn->ComputeInvariants(); }
+  timer.Start(time_passes::Phase::CheckInvariants);
   for (auto &fn : ctx.mod_->fns_) { fn->CheckInvariants(); }
+  timer.Stop();
+
+  // Other modules may reuse this module's instantiations of generic functions
+  // from now on, rather than instantiating their own. Those whose bodies have
+  // not been parsed yet are left out, as completing them is not thread-safe.
+  for (auto const & [ id, data ] : ctx.mod_->data_) {
+    if (id == 0) { continue; }
+    for (auto const & [ expr, fn ] : data->ir_funcs_) {
+      if (!expr->is<ast::FunctionLiteral>() || fn->work_item != nullptr) {
+        continue;
+      }
+      ast::PublishInstantiation(expr, id, fn);
+    }
+  }
 
 #ifdef ICARUS_USE_LLVM
+  timer.Start(time_passes::Phase::EmitLlvm);
   backend::EmitAll(ctx.mod_->fns_, ctx.mod_->llvm_.get());
+  timer.Stop();
 #endif  // ICARUS_USE_LLVM
 
   for (auto const &stmt : ctx.mod_->statements_.content_) {
@@ -185,7 +412,8 @@ static Module const *CompileModule(Module *mod) {
     ir_fn->llvm_fn_->setName("main");
     ir_fn->llvm_fn_->setLinkage(llvm::GlobalValue::ExternalLinkage);
 #else
-    main_fn = ir_fn;
+    main_fn         = ir_fn;
+    ctx.mod_->main_ = ir_fn;
 #endif  // ICARUS_USE_LLVM
   }
 
@@ -200,11 +428,41 @@ static Module const *CompileModule(Module *mod) {
   return mod;
 }
 
+static Module const *CompileModule(Module *mod) {
+  auto *result = CompileSource(mod);
+  // Errors found while compiling quote the source, but once that's done only
+  // function bodies skipped over by a lazy parse still need it.
+  if (!mod->lazy_function_bodies_) { mod->source_.reset(); }
+  return result;
+}
+
+std::unique_lock<std::recursive_mutex> Module::LockData() const {
+  if (!lazy_function_bodies_ && claims_ == nullptr) { return {}; }
+  return std::unique_lock(data_mtx_);
+}
+
+Module::DependentData &Module::data(ast::BoundConstants const &bc) {
+  u32 id = bc.id();
+  auto lock = LockData();
+  auto &data = data_[id];
+  if (data == nullptr) { data = std::make_unique<DependentData>(); }
+  return *data;
+}
+
+Module::DependentData const *Module::find_data(
+    ast::BoundConstants const &bc) const {
+  u32 id = bc.id();
+  auto lock = LockData();
+  auto iter = data_.find(id);
+  return iter == data_.end() ? nullptr : iter->second.get();
+}
+
 type::Type const *Module::type_of(ast::BoundConstants const &bc,
                                   ast::Expression const *expr) const {
-  if (auto bc_iter = data_.find(bc); bc_iter != data_.end()) {
-    auto iter = bc_iter->second.types_.data_.find(expr);
-    if (iter != bc_iter->second.types_.data_.end()) { return iter->second; }
+  auto lock = LockData();
+  if (auto *data = find_data(bc)) {
+    auto iter = data->types_.data_.find(expr);
+    if (iter != data->types_.data_.end()) { return iter->second; }
   }
 
   return nullptr;
@@ -212,36 +470,72 @@ type::Type const *Module::type_of(ast::BoundConstants const &bc,
 
 ir::Register Module::addr(ast::BoundConstants const &bc,
                           ast::Declaration *decl) const {
-  return data_.at(bc).addr_.at(decl);
+  auto lock = LockData();
+  return ASSERT_NOT_NULL(find_data(bc))->addr_.at(decl);
 }
 
 type::Type const *Module::set_type(ast::BoundConstants const &bc,
                                    ast::Expression const *expr,
                                    type::Type const *t) {
-  data_[bc].types_.emplace(expr, t);
+  auto lock = LockData();
+  data(bc).types_.emplace(expr, t);
   return t;
 }
 
-PendingModule Module::Schedule(std::filesystem::path const &src,
-                               std::filesystem::path const &requestor) {
+base::Claim Module::ClaimOwnerOf(ast::Node const *node) const {
+  if (claims_ == nullptr) { return base::Claim(); }
+  if (auto iter = claim_parts_.find(node); iter != claim_parts_.end()) {
+    return base::Claim(claims_.get(), iter->second);
+  }
+
+  // Anything within a top-level function literal is found through the scope
+  // it opens, just inside the global scope.
+  Scope const *scope = node->scope_;
+  while (scope != nullptr && scope->parent != global_.get()) {
+    scope = scope->parent;
+  }
+  if (auto *fn_scope = scope ? scope->if_as<FnScope>() : nullptr) {
+    if (auto iter = claim_parts_.find(fn_scope->fn_lit_);
+        iter != claim_parts_.end()) {
+      return base::Claim(claims_.get(), iter->second);
+    }
+  }
+  return base::Claim(claims_.get(), nullptr);
+}
+
+base::Claim Module::ClaimAll() const {
+  return base::Claim(claims_.get(), nullptr);
+}
+
+base::expected<PendingModule, base::vector<std::filesystem::path const *>>
+Module::Schedule(std::filesystem::path const &src,
+                 std::filesystem::path const *requestor) {
   std::lock_guard lock(mtx);
-  auto[src_ptr, newly_inserted] = import_graph.node(src);
-  ASSERT(src_ptr != nullptr);
+  auto *src_ptr = import_graph.node(src).first;
+  if (src_ptr == nullptr) {
+    return base::vector<std::filesystem::path const *>{};
+  }
 
   // Need to add dependencies even if the node was already scheduled (hence the
   // "already scheduled" check is done after this).
-  if (requestor != std::filesystem::path{""}) {
-    ASSERT(import_graph.AddDependency(
-        src_ptr, ASSERT_NOT_NULL(import_graph.node(requestor).first)));
+  if (requestor != nullptr) {
+    auto cycle = import_graph.AddDependency(src_ptr, requestor);
+    // A module is never scheduled if its first import attempt is cyclic: the
+    // requestor is already in the graph, so `src` must be too.
+    if (!cycle.empty()) { return cycle; }
   }
 
-  if (!newly_inserted) {
-    return PendingModule{ASSERT_NOT_NULL(modules[src_ptr].first)};
+  // Paths stay in the import graph after their module is invalidated, so
+  // whether we have scheduled this module is tracked by `modules` alone.
+  if (auto iter = modules.find(src_ptr); iter != modules.end()) {
+    return PendingModule{ASSERT_NOT_NULL(iter->second.first)};
   }
 
   auto & [ fut, mod ] = modules[src_ptr];
   ASSERT(fut == nullptr);
-  mod.path_ = src_ptr;
+  mod.path_                 = src_ptr;
+  mod.lazy_function_bodies_ =
+      feature::lazy_function_bodies && requestor != nullptr;
   fut       = &pending_module_futures.emplace_back(
       std::async(std::launch::async, CompileModule, &mod));
   return PendingModule{fut};
@@ -249,8 +543,16 @@ PendingModule Module::Schedule(std::filesystem::path const &src,
 
 Module const *PendingModule::get() {
   if ((data_ & 1) == 0) { return reinterpret_cast<Module const *>(data_); }
-  Module const *result =
-      reinterpret_cast<std::shared_future<Module const *> *>(data_ - 1)->get();
+  auto *fut = reinterpret_cast<std::shared_future<Module const *> *>(data_ - 1);
+  // Only time waits which actually block.
+  if (base::trace::enabled &&
+      fut->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    u64 wait_start = base::trace::Now();
+    fut->wait();
+    base::trace::Complete("import", "wait for import", wait_start,
+                          fut->get()->path_->string());
+  }
+  Module const *result = fut->get();
   *this = PendingModule{result};
   return result;
 }
@@ -269,3 +571,56 @@ void AwaitAllModulesTransitively() {
     ++iter;
   }
 }
+
+base::vector<std::filesystem::path const *> ScheduledModulePaths() {
+  std::lock_guard lock(mtx);
+  base::vector<std::filesystem::path const *> paths;
+  paths.reserve(modules.size());
+  for (auto const & [ path, fut_and_mod ] : modules) { paths.push_back(path); }
+  return paths;
+}
+
+Module const *ScheduledModule(std::filesystem::path const *path) {
+  std::lock_guard lock(mtx);
+  auto iter = modules.find(path);
+  return iter == modules.end() ? nullptr : &iter->second.second;
+}
+
+base::vector<std::filesystem::path const *> KnownModulePaths() {
+  std::lock_guard lock(mtx);
+  return import_graph.paths();
+}
+
+base::vector<std::filesystem::path const *> InvalidateModules(
+    base::vector<std::filesystem::path const *> const &paths) {
+  std::lock_guard lock(mtx);
+  auto invalidated = import_graph.WithTransitiveImporters(paths);
+  // A module which found an instantiation owned by an invalidated module may
+  // refer to it without importing that module, so it goes too, along with its
+  // own importers.
+  while (true) {
+    std::unordered_set<std::filesystem::path const *> handled(
+        invalidated.begin(), invalidated.end());
+    base::vector<std::filesystem::path const *> users;
+    for (auto *path : invalidated) {
+      auto iter = modules.find(path);
+      if (iter == modules.end()) { continue; }
+      for (auto *user : ast::InstantiationUsers(&iter->second.second)) {
+        if (handled.insert(user->path_).second) { users.push_back(user->path_); }
+      }
+    }
+    if (users.empty()) { break; }
+    users.insert(users.end(), invalidated.begin(), invalidated.end());
+    invalidated = import_graph.WithTransitiveImporters(users);
+  }
+  for (auto *path : invalidated) {
+    import_graph.ClearDependencies(path);
+    auto iter = modules.find(path);
+    if (iter == modules.end()) { continue; }
+    auto *fut = iter->second.first;
+    pending_module_futures.remove_if(
+        [fut](auto const &pending) { return &pending == fut; });
+    modules.erase(iter);
+  }
+  return invalidated;
+}
@@ -1,6 +1,7 @@
 #ifndef ICARUS_MODULE_H
 #define ICARUS_MODULE_H
 
+#include <deque>
 #include <filesystem>
 #include <future>
 #include <memory>
@@ -14,9 +15,14 @@
 #include "ast/fn_params.h"
 #include "ast/node_lookup.h"
 #include "ast/statements.h"
+#include "base/arena.h"
+#include "base/claim.h"
 #include "base/container/unordered_map.h"
 #include "base/container/vector.h"
+#include "base/expected.h"
+#include "base/untyped_buffer.h"
 #include "scope.h"
+#include "symbol.h"
 
 #ifdef ICARUS_USE_LLVM
 namespace llvm {
@@ -40,6 +46,10 @@ struct FunctionLiteral;
 struct StructLiteral;
 }  // namespace ast
 
+namespace frontend {
+struct File;
+}  // namespace frontend
+
 struct PendingModule;
 
 struct Module {
@@ -49,16 +59,46 @@ struct Module {
   // We take pointers to the module, so it cannot be moved.
   Module(Module &&) = delete;
 
-  static PendingModule Schedule(
-      std::filesystem::path const &src,
-      std::filesystem::path const &requestor = std::filesystem::path{""});
+  // Schedules `src` to be compiled (if it has not been already) and records
+  // that `requestor` imports it. If that import would be cyclic, nothing is
+  // scheduled and the cycle of paths is returned instead. If there is no file
+  // at `src`, nothing is scheduled and an empty vector is returned.
+  static base::expected<PendingModule,
+                        base::vector<std::filesystem::path const *>>
+  Schedule(std::filesystem::path const &src,
+           std::filesystem::path const *requestor = nullptr);
 
   ir::Func *AddFunc(type::Function const *fn_type,
                     ast::FnParams<ast::Expression *> params);
-  type::Type const *GetType(std::string const &name) const;
-  ast::Declaration *GetDecl(std::string const &name) const;
+  type::Type const *GetType(Symbol name) const;
+  ast::Declaration *GetDecl(Symbol name) const;
+  // Returns every declaration named `name` which this module exports, in the
+  // order they were declared, along with their types.
+  base::vector<type::Typed<ast::Declaration *>> const &GetExports(
+      Symbol name) const;
+
+  // Fills `exports_` from `statements_`. Called once the module has been
+  // verified, before any other module may look up its declarations.
+  void IndexExports();
+
+  // Own the memory for every node parsed from this module's source, one arena
+  // per thread which parsed part of it. Declared before everything else so
+  // that they are destroyed last, after anything which may still hold those
+  // nodes.
+  std::deque<base::Arena> ast_arenas_;
+
+  // The source this module was parsed from. Released once the module is
+  // compiled, unless function bodies were skipped over by a lazy parse, in
+  // which case it is kept so they can be parsed when they are first needed.
+  std::unique_ptr<frontend::File> source_;
+
+  // Whether the bodies of functions in this module are only parsed and
+  // verified once they are needed. Set for imported modules when compiling
+  // with `--lazy-function-bodies`.
+  bool lazy_function_bodies_ = false;
 
-  std::map<ast::BoundConstants, std::unordered_set<ast::Expression const *>>
+  // Keyed on the id of the bound constants.
+  base::unordered_map<u32, std::unordered_set<ast::Expression const *>>
       completed_;
 
   struct CompilationWorkItem {
@@ -72,22 +112,39 @@ struct Module {
     Module *mod_;
   };
   std::queue<CompilationWorkItem> to_complete_;
+  // Work items for functions whose bodies have not been parsed yet. Each is
+  // completed when the function is first called from code completed by
+  // `CompleteAll`, or when it is first executed.
+  std::deque<CompilationWorkItem> deferred_;
   void CompleteAll();
 
+  // Completes `fn` if its body has not been completed yet, waiting if another
+  // thread is completing it. Bodies skipped over by a lazy parse are completed
+  // by whichever module first needs them, so this may be called from any
+  // thread.
+  static void CompleteFunc(ir::Func *fn);
+  // Held while completing any of this module's work items, which adds to its
+  // functions and data. Recursive, since completing one body may execute, and
+  // so complete, another.
+  std::recursive_mutex completion_mtx_;
+
   std::unique_ptr<DeclScope> global_;
 
   // Holds all constants defined in the module (both globals and scoped
-  // constants). These are the values in the map. They're keyed on conditional
-  // constants. So we have options for mulitple meanings of things depending on
+  // constants). These are the values in the map. They're keyed on the id of
+  // conditional constants. So we have options for mulitple meanings of things depending on
   // context.
   //
   // TODO Almost surely this needs to be even deeper, treating it as a tree
   // of arbitrary depth.
-  base::map<ast::BoundConstants, ast::BoundConstants> constants_;
+  base::unordered_map<u32, base::map<ast::Declaration const *, ir::Val>>
+      constants_;
 
   // TODO long-term this is not a good way to store these. We should probably
   // extract the declarations determine which are public, etc.
   ast::Statements statements_;
+  // The exported declarations in `statements_`, keyed on name.
+  ExportTable exports_;
 
 #ifdef ICARUS_USE_LLVM
   std::unique_ptr<llvm::LLVMContext> llvm_ctx_;
@@ -102,11 +159,6 @@ struct Module {
                             ast::Expression const *expr) const;
   ir::Register addr(ast::BoundConstants const &bc,
                     ast::Declaration *decl) const;
-           
-  // TODO support more than just a single type argument to generic structs.
-  base::unordered_map<ast::StructLiteral *,
-                      base::map<type::Type const *, type::Type const *>>
-      generic_struct_cache_;
 
   struct DependentData {
     ast::NodeLookup<type::Type const *> types_;
@@ -115,19 +167,102 @@ struct Module {
 
     base::unordered_map<ast::Expression const *, ir::Func *> ir_funcs_;
 
-    base::unordered_map<ast::Expression const *, ast::DispatchTable>
+    base::unordered_map<ast::Expression const *,
+                        std::shared_ptr<ast::DispatchTable const>>
         dispatch_tables_;
     // For use with expression nodes that have more than one dispatch table.
-    base::unordered_map<ast::Node const *, base::vector<ast::DispatchTable>>
+    base::unordered_map<ast::Node const *,
+                        base::vector<std::shared_ptr<ast::DispatchTable const>>>
         repeated_dispatch_tables_;
+    // Dispatch tables (and return types) already computed for calls without
+    // named or expanded arguments, shared by every call with the same
+    // signature. See `ast::DispatchTable::Make`.
+    base::unordered_map<ast::DispatchSignature,
+                        std::pair<std::shared_ptr<ast::DispatchTable const>,
+                                  type::Type const *>>
+        dispatch_cache_;
+
+    // Results of evaluating expressions at compile time. See
+    // `backend::EvaluateToBuffer` for which results are cached.
+    base::unordered_map<ast::Expression const *, base::untyped_buffer>
+        evaluated_;
+    // Functions emitted to evaluate expressions at compile time, kept so that
+    // evaluating the same expression again need only execute its function.
+    base::unordered_map<ast::Expression const *, std::unique_ptr<ir::Func>>
+        eval_fns_;
   };
-  std::map<ast::BoundConstants, DependentData> data_;
+  // Returns the data for the instantiation with bound constants `bc`,
+  // creating it if there is none yet.
+  DependentData &data(ast::BoundConstants const &bc);
+  // Returns the data for the instantiation with bound constants `bc`, or null
+  // if there is none.
+  DependentData const *find_data(ast::BoundConstants const &bc) const;
+
+  // Keyed on the id of the bound constants. Ids are shared by every module, so
+  // each holds only those it has instantiated. Allocated separately so that
+  // growing the table never moves an instantiation's data.
+  base::unordered_map<u32, std::unique_ptr<DependentData>> data_;
+
+  // Guards `data_` and `constants_` while top-level declarations are verified
+  // in parallel. Compile-time evaluation claims the whole module, so the data
+  // only it touches is not guarded.
+  mutable std::recursive_mutex data_mtx_;
+  // Locks `data_mtx_`, but only if another thread may touch the data at the
+  // same time: while top-level declarations are verified in parallel, or at
+  // any time in a module whose function bodies are completed lazily, since
+  // any module importing it may complete them. Otherwise the lock returned
+  // holds nothing.
+  std::unique_lock<std::recursive_mutex> LockData() const;
+
+  // Set only while top-level declarations are verified in parallel, with a
+  // part for each of them. Everything done to a declaration is done with its
+  // part claimed, so each is worked on by one thread at a time.
+  std::unique_ptr<base::ClaimGroup> claims_;
+  // The part for each top-level declaration, and for the function literal it
+  // is initialized with, if any.
+  base::unordered_map<ast::Node const *, base::ClaimGroup::Part *>
+      claim_parts_;
+
+  // Claims the top-level declaration containing `node`, or the whole module if
+  // there is none to be found (e.g., `node` is from another module). Claims
+  // nothing unless declarations are being verified in parallel.
+  base::Claim ClaimOwnerOf(ast::Node const *node) const;
+  // Claims the whole module, waiting until every other thread verifying it is
+  // blocked.
+  base::Claim ClaimAll() const;
 
   std::filesystem::path const *path_ = nullptr;
+
+  // The modification time of the source file, taken before it was read, and a
+  // hash of the bytes read. See `frontend::File`.
+  std::filesystem::file_time_type source_mtime_;
+  size_t source_hash_ = 0;
+
+  // The module's `main` function, if it declares one.
+  ir::Func *main_ = nullptr;
 };
 
 void AwaitAllModulesTransitively();
 
+// Returns the path of every module which has been scheduled for compilation.
+base::vector<std::filesystem::path const *> ScheduledModulePaths();
+
+// Returns the module compiled from `path`, or null if it has not been
+// scheduled. Must not be called while that module is still compiling.
+Module const *ScheduledModule(std::filesystem::path const *path);
+
+// Returns the path of every module which has ever been scheduled, including
+// those since invalidated.
+base::vector<std::filesystem::path const *> KnownModulePaths();
+
+// Destroys the modules compiled from `paths`, along with every module which
+// (transitively) imports one of them or uses an instantiation one of them owns,
+// so that scheduling any of them again recompiles it from source. Returns the
+// paths of all modules invalidated. Must not be called while any module is
+// still compiling.
+base::vector<std::filesystem::path const *> InvalidateModules(
+    base::vector<std::filesystem::path const *> const &paths);
+
 struct PendingModule {
  public:
   PendingModule() = default;
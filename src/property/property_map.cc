@@ -154,6 +154,11 @@ void PropertyMap::MarkReferencesStale(Entry const &e,
       stale_down->emplace(&fn_->block(last_cmd.cond_jump_.blocks_[0]), e.reg_);
       stale_down->emplace(&fn_->block(last_cmd.cond_jump_.blocks_[1]), e.reg_);
       break;
+    case ir::Op::TypeJump:
+      for (auto const & [ t, block ] : *last_cmd.type_jump_.jump_table_) {
+        stale_down->emplace(&fn_->block(block), e.reg_);
+      }
+      break;
     case ir::Op::ReturnJump: break;
     default: UNREACHABLE();
   }
@@ -183,6 +188,7 @@ bool PropertyMap::UpdateEntryFromAbove(Entry const &e) {
   switch (cmd.op_code_) {
     case ir::Op::UncondJump: return /* TODO */ false;
     case ir::Op::CondJump: return /* TODO */ false;
+    case ir::Op::TypeJump: return /* TODO */ false;
     case ir::Op::ReturnJump: return /* TODO */ false;
     case ir::Op::Call: return /* TODO */ false;
     case ir::Op::NotBool: return prop_set.add(Not(block_view.at(cmd.reg_)));
@@ -0,0 +1,67 @@
+#include "run/compile.h"
+
+#include <dlfcn.h>
+#include <atomic>
+#include <iostream>
+#include <unordered_set>
+
+#include "backend/exec.h"
+#include "base/debug.h"
+#include "base/untyped_buffer.h"
+#include "ir/func.h"
+#include "module.h"
+
+extern std::atomic<bool> found_errors;
+
+LibcHandle::LibcHandle()
+    : handle_(dlopen("/lib/x86_64-linux-gnu/libc.so.6", RTLD_LAZY)) {
+  ASSERT(handle_ != nullptr);
+}
+
+LibcHandle::~LibcHandle() { dlclose(handle_); }
+
+base::vector<std::filesystem::path const *> CompileRoots(
+    base::vector<std::filesystem::path> const &roots, bool run) {
+  auto previously_scheduled = ScheduledModulePaths();
+  std::unordered_set<std::filesystem::path const *> resident(
+      previously_scheduled.begin(), previously_scheduled.end());
+
+  found_errors = false;
+  base::vector<PendingModule> pending_roots;
+  for (auto const &src : roots) {
+    // A root is never imported by anything, so scheduling it can't be cyclic,
+    // but the file may not exist.
+    auto pending = Module::Schedule(src);
+    if (!pending) {
+      std::cerr << "No such file \"" << src.string() << "\".\n";
+      found_errors = true;
+      continue;
+    }
+    pending_roots.push_back(*pending);
+  }
+  AwaitAllModulesTransitively();
+
+  base::vector<std::filesystem::path const *> compiled;
+  for (auto *path : ScheduledModulePaths()) {
+    if (resident.count(path) == 0) { compiled.push_back(path); }
+  }
+
+  if (found_errors) {
+    // Modules with errors must not be reused, or the errors would go
+    // unreported next time. We don't track which of the modules compiled here
+    // failed, so drop them all.
+    InvalidateModules(compiled);
+    return {};
+  }
+
+  if (!run) { return compiled; }
+  for (auto &root : pending_roots) {
+    auto *main_fn = root.get()->main_;
+    if (main_fn == nullptr) { continue; }
+    backend::ExecContext exec_ctx;
+    backend::Execute(main_fn, base::untyped_buffer(0), {}, &exec_ctx);
+    return compiled;
+  }
+  std::cerr << "No compiled module has a `main` function.\n";
+  return compiled;
+}
@@ -0,0 +1,28 @@
+#ifndef ICARUS_RUN_COMPILE_H
+#define ICARUS_RUN_COMPILE_H
+
+#include <filesystem>
+#include "base/container/vector.h"
+
+// Keeps the C standard library loaded for as long as the object lives, so that
+// foreign functions can be found in it when executing code.
+struct LibcHandle {
+  LibcHandle();
+  ~LibcHandle();
+
+  LibcHandle(LibcHandle const &) = delete;
+
+ private:
+  void *handle_;
+};
+
+// Compiles every module in `roots`, reusing any module still resident from an
+// earlier call. If any errors are found, every module compiled by this call is
+// invalidated again, so that the errors are reported again next time, and an
+// empty vector is returned. Otherwise, returns the paths of the modules this
+// call compiled and, if `run` is set, executes the first `main` found among the
+// roots.
+base::vector<std::filesystem::path const *> CompileRoots(
+    base::vector<std::filesystem::path> const &roots, bool run);
+
+#endif  // ICARUS_RUN_COMPILE_H
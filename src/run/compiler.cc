@@ -1,13 +1,13 @@
-#include <dlfcn.h>
 #include <filesystem>
 
 #include "backend/exec.h"
+#include "backend/profile.h"
 #include "base/container/vector.h"
 #include "base/untyped_buffer.h"
-#include "base/util.h"
 #include "context.h"
 #include "ir/func.h"
 #include "module.h"
+#include "run/compile.h"
 
 #ifdef ICARUS_USE_LLVM
 #include "llvm/ADT/STLExtras.h"
@@ -23,9 +23,7 @@ extern ir::Func *main_fn;
 extern std::atomic<bool> found_errors;
 
 int RunCompiler() {
-  void *libc_handle = dlopen("/lib/x86_64-linux-gnu/libc.so.6", RTLD_LAZY);
-  ASSERT(libc_handle != nullptr);
-  base::defer d([libc_handle] { dlclose(libc_handle); });
+  LibcHandle libc;
 
 #ifdef ICARUS_USE_LLVM
   llvm::InitializeAllTargetInfos();
@@ -35,8 +33,24 @@ int RunCompiler() {
   llvm::InitializeAllAsmPrinters();
 #endif  // ICARUS_USE_LLVM
 
+#ifndef ICARUS_USE_LLVM
+  std::optional<backend::Profile> profile;
+  if (backend::profile_input != nullptr) {
+    profile = backend::Profile::Read(backend::profile_input);
+    if (!profile) {
+      std::cerr << "Failed to read the profile \"" << backend::profile_input
+                << "\".\n";
+      return 1;
+    }
+    backend::active_profile = &*profile;
+  }
+#endif  // ICARUS_USE_LLVM
+
   for (const auto &src : files) {
-    Module::Schedule(std::filesystem::path{src});
+    if (!Module::Schedule(std::filesystem::path{src})) {
+      std::cerr << "No such file \"" << src << "\".\n";
+      found_errors = true;
+    }
   }
   AwaitAllModulesTransitively();
 
@@ -48,7 +62,16 @@ int RunCompiler() {
   } else if (!found_errors) {
     ASSERT(main_fn->mod_ != nullptr);
     backend::ExecContext exec_ctx;
+    backend::BranchCounts branch_counts;
+    if (backend::profile_output != nullptr) {
+      exec_ctx.branch_counts_ = &branch_counts;
+    }
     backend::Execute(main_fn, base::untyped_buffer(0), {}, &exec_ctx);
+    if (backend::profile_output != nullptr &&
+        !branch_counts.profile().Write(backend::profile_output)) {
+      std::cerr << "Failed to write the profile \"" << backend::profile_output
+                << "\".\n";
+    }
   }
 #endif
 
@@ -0,0 +1,183 @@
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include "base/container/unordered_map.h"
+#include "base/container/vector.h"
+#include "base/util.h"
+#include "module.h"
+#include "run/compile.h"
+
+// A persistent compile server. It listens on a Unix domain socket and keeps
+// every compiled module (and with them the interned types and IR) resident
+// between requests, so repeated compiles only pay for what changed on disk.
+//
+// Each connection carries a single request line, one of:
+//
+//   compile <path>
+//   run <path>
+//   shutdown
+//
+// All diagnostics (and for `run`, the program's output) are written back over
+// the connection, which the server closes once the request is complete.
+// Relative paths, including those in `import` statements, are resolved against
+// the server's working directory, so clients should send absolute paths.
+
+char const *server_socket = nullptr;
+
+namespace {
+struct SourceStamp {
+  std::filesystem::file_time_type mtime_;
+  size_t hash_ = 0;
+};
+
+std::optional<SourceStamp> ComputeStamp(std::filesystem::path const &path) {
+  std::error_code ec;
+  auto mtime = std::filesystem::last_write_time(path, ec);
+  if (ec) { return std::nullopt; }
+  std::ifstream ifs(path);
+  if (!ifs) { return std::nullopt; }
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  return SourceStamp{mtime, std::hash<std::string>{}(ss.str())};
+}
+
+// Source stamps of every resident module, of the bytes it was compiled from.
+// Stamping the file on disk once compiling is done would record edits made
+// while compiling against the stale module.
+base::unordered_map<std::filesystem::path const *, SourceStamp> stamps;
+
+// Invalidates every resident module whose source has changed since it was
+// compiled. A newer modification time alone is not enough: the contents must
+// hash differently too, so touching a file does not throw its module away.
+void InvalidateStaleModules() {
+  base::vector<std::filesystem::path const *> stale;
+  for (auto *path : ScheduledModulePaths()) {
+    auto iter = stamps.find(path);
+    if (iter == stamps.end()) {
+      stale.push_back(path);
+      continue;
+    }
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(*path, ec);
+    if (!ec && mtime == iter->second.mtime_) { continue; }
+    auto stamp = ComputeStamp(*path);
+    if (stamp && stamp->hash_ == iter->second.hash_) {
+      iter->second.mtime_ = stamp->mtime_;
+      continue;
+    }
+    stale.push_back(path);
+  }
+  if (stale.empty()) { return; }
+  for (auto *path : InvalidateModules(stale)) { stamps.erase(path); }
+}
+
+// Points stdout and stderr at `fd` for the lifetime of the object.
+struct RedirectOutput {
+  explicit RedirectOutput(int fd) {
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    saved_out_ = dup(STDOUT_FILENO);
+    saved_err_ = dup(STDERR_FILENO);
+    dup2(fd, STDOUT_FILENO);
+    dup2(fd, STDERR_FILENO);
+  }
+
+  ~RedirectOutput() {
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    dup2(saved_out_, STDOUT_FILENO);
+    dup2(saved_err_, STDERR_FILENO);
+    close(saved_out_);
+    close(saved_err_);
+  }
+
+ private:
+  int saved_out_;
+  int saved_err_;
+};
+
+void Compile(std::filesystem::path const &src, bool run) {
+  InvalidateStaleModules();
+  for (auto *path : CompileRoots({src}, run)) {
+    auto const *mod = ASSERT_NOT_NULL(ScheduledModule(path));
+    stamps.emplace(path, SourceStamp{mod->source_mtime_, mod->source_hash_});
+  }
+}
+
+// Handles the single request on `fd`. Returns false if the server should shut
+// down.
+bool HandleRequest(int fd) {
+  std::string request;
+  char c;
+  while (read(fd, &c, 1) == 1 && c != '\n') { request.push_back(c); }
+
+  RedirectOutput redirect(fd);
+  if (request == "shutdown") { return false; }
+
+  auto space = request.find(' ');
+  std::string command = request.substr(0, space);
+  if (space == std::string::npos ||
+      (command != "compile" && command != "run")) {
+    std::cerr << "Invalid request \"" << request << "\".\n";
+    return true;
+  }
+
+  std::filesystem::path src(request.substr(space + 1));
+  std::error_code ec;
+  if (!std::filesystem::exists(src, ec)) {
+    std::cerr << "No such file \"" << src.string() << "\".\n";
+    return true;
+  }
+  Compile(src, command == "run");
+  return true;
+}
+}  // namespace
+
+int RunServer() {
+  LibcHandle libc;
+
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (std::strlen(server_socket) >= sizeof(addr.sun_path)) {
+    std::cerr << "Socket path \"" << server_socket << "\" is too long.\n";
+    return -1;
+  }
+  std::strcpy(addr.sun_path, server_socket);
+
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) {
+    std::perror("socket");
+    return -1;
+  }
+  base::defer close_listen([listen_fd] {
+    close(listen_fd);
+    unlink(server_socket);
+  });
+
+  unlink(server_socket);
+  if (bind(listen_fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+      listen(listen_fd, SOMAXCONN) < 0) {
+    std::perror(server_socket);
+    return -1;
+  }
+
+  bool keep_serving = true;
+  while (keep_serving) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) { continue; }
+    keep_serving = HandleRequest(fd);
+    close(fd);
+  }
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <unordered_set>
+
+#include "base/container/unordered_map.h"
+#include "base/container/vector.h"
+#include "frontend/source.h"
+#include "module.h"
+#include "run/compile.h"
+
+// Watch mode: compiles and runs the given files, then waits for any source in
+// the import graph to change. On a change, only the modules compiled from the
+// changed files and the modules (transitively) importing them are recompiled.
+// Every other module, along with its IR, is reused as is.
+
+extern base::vector<frontend::Source::Name> files;
+
+namespace {
+// How long to keep collecting file-system events after the first one, so that
+// an editor saving several files (or one file in several steps) triggers a
+// single rebuild.
+constexpr int kDebounceMillis = 50;
+
+struct Watcher {
+  Watcher() : fd_(inotify_init1(IN_CLOEXEC)) {}
+  ~Watcher() { close(fd_); }
+
+  bool ok() const { return fd_ >= 0; }
+
+  // Watches the directory containing `path` rather than `path` itself, so
+  // that we still see changes made by editors which save by replacing the
+  // file.
+  void Watch(std::filesystem::path const *path) {
+    if (!watched_.insert(path).second) { return; }
+    auto dir = path->parent_path();
+    int wd   = inotify_add_watch(fd_, dir.c_str(),
+                               IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0) {
+      std::cerr << "Failed to watch \"" << dir.string() << "\".\n";
+      return;
+    }
+    dirs_.emplace(wd, std::move(dir));
+  }
+
+  // Blocks until at least one watched path changes and returns all of the
+  // watched paths which changed.
+  base::vector<std::filesystem::path const *> AwaitChanges() {
+    base::vector<std::filesystem::path const *> changed;
+    while (changed.empty()) {
+      ReadEvents(&changed);
+      pollfd pfd{fd_, POLLIN, 0};
+      while (poll(&pfd, 1, kDebounceMillis) > 0) { ReadEvents(&changed); }
+    }
+    return changed;
+  }
+
+ private:
+  void ReadEvents(base::vector<std::filesystem::path const *> *changed) {
+    alignas(inotify_event) char buf[4096];
+    ssize_t len = read(fd_, buf, sizeof(buf));
+    for (ssize_t i = 0; i < len;) {
+      auto *event = reinterpret_cast<inotify_event *>(buf + i);
+      i += sizeof(inotify_event) + event->len;
+      if (event->len == 0) { continue; }
+      auto iter = dirs_.find(event->wd);
+      if (iter == dirs_.end()) { continue; }
+      auto path = iter->second / event->name;
+      for (auto *watched : watched_) {
+        if (*watched != path) { continue; }
+        if (std::find(changed->begin(), changed->end(), watched) ==
+            changed->end()) {
+          changed->push_back(watched);
+        }
+      }
+    }
+  }
+
+  int fd_;
+  base::unordered_map<int, std::filesystem::path> dirs_;
+  std::unordered_set<std::filesystem::path const *> watched_;
+};
+
+}  // namespace
+
+int RunWatch() {
+  LibcHandle libc;
+
+  Watcher watcher;
+  if (!watcher.ok()) {
+    std::perror("inotify_init1");
+    return -1;
+  }
+
+  base::vector<std::filesystem::path> roots(files.begin(), files.end());
+  while (true) {
+    CompileRoots(roots, true);
+    std::cout.flush();
+    std::fflush(nullptr);
+
+    // Modules with errors have been invalidated, but the files must still be
+    // watched so that fixing them triggers a rebuild. `Watch` ignores paths it
+    // has already seen, so this also picks up newly added imports.
+    for (auto *path : KnownModulePaths()) { watcher.Watch(path); }
+
+    auto changed = watcher.AwaitChanges();
+    for (auto *path : changed) {
+      std::cerr << "\n-- " << path->string() << " changed. Rebuilding.\n\n";
+    }
+    InvalidateModules(changed);
+  }
+}
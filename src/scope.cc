@@ -9,10 +9,33 @@
 #include "type/function.h"
 #include "type/pointer.h"
 
+void Scope::InvalidateLookups(Symbol id) {
+  auto iter = dependents_.find(id);
+  if (iter == dependents_.end()) { return; }
+  for (auto *lookup : iter->second) { lookup->valid_ = false; }
+}
+
 void Scope::InsertDecl(ast::Declaration *decl) {
-  decls_[decl->id_].push_back(decl);
-  for (auto *scope_ptr = parent; scope_ptr; scope_ptr = scope_ptr->parent) {
-    scope_ptr->child_decls_[decl->id_].push_back(decl);
+  {
+    std::lock_guard lock(mtx_);
+    decls_[decl->id_].push_back(decl);
+    InvalidateLookups(decl->id_);
+    if (root_ == this) {
+      tree_decls_[decl->id_].push_back(decl);
+      return;
+    }
+  }
+  std::lock_guard lock(root_->mtx_);
+  root_->tree_decls_[decl->id_].push_back(decl);
+}
+
+void Scope::EmbedModule(Module const *mod) {
+  std::lock_guard lock(mtx_);
+  if (!embedded_modules_.insert(mod).second) { return; }
+  embedded_exports_.push_back(&mod->exports_);
+  // The module may export anything, so every lookup through here is stale.
+  for (auto & [ id, lookups ] : dependents_) {
+    for (auto *lookup : lookups) { lookup->valid_ = false; }
   }
 }
 
@@ -22,31 +45,67 @@ Module const *Scope::module() const {
 }
 
 // TODO error version will always have nullptr types.
-base::vector<type::Typed<ast::Declaration *>> Scope::AllDeclsWithId(
-    std::string const &id, Context *ctx) const {
-  base::vector<type::Typed<ast::Declaration *>> matching_decls;
+base::vector<type::Typed<ast::Declaration *>> const &Scope::AllDeclsWithId(
+    Symbol id) const {
+  std::lock_guard lock(mtx_);
+  auto[iter, inserted] = lookups_.try_emplace(id);
+  auto &lookup         = iter->second;
+  if (lookup.valid_) { return *lookup.decls_; }
+
+  // Marked valid before the scopes are read, so that a declaration added to
+  // one of them while it is being read marks the list stale again.
+  lookup.valid_ = true;
+  auto &decls   = lists_.emplace_back();
   for (auto scope_ptr = this; scope_ptr != nullptr;
        scope_ptr      = scope_ptr->parent) {
-    if (auto iter = scope_ptr->decls_.find(id);
-        iter != scope_ptr->decls_.end()) {
-      for (auto *decl : iter->second) {
-        auto *t = ctx->type_of(decl);
-        // TODO This will call VerifyType once if it's correct, but *every* time
-        // if it's incorrect. Fix this.
-        if (t == nullptr) { t = decl->VerifyType(ctx).type_; }
-        matching_decls.emplace_back(decl, t);
-      }
+    // Scopes are always locked innermost first.
+    std::unique_lock<std::mutex> outer_lock;
+    if (scope_ptr != this) {
+      outer_lock = std::unique_lock<std::mutex>(scope_ptr->mtx_);
     }
+    if (inserted) { scope_ptr->dependents_[id].push_back(&lookup); }
 
-    for (auto const *mod : scope_ptr->embedded_modules_) {
+    if (auto decls_iter = scope_ptr->decls_.find(id);
+        decls_iter != scope_ptr->decls_.end()) {
+      for (auto *decl : decls_iter->second) { decls.emplace_back(decl, nullptr); }
+    }
+
+    for (auto const *exports : scope_ptr->embedded_exports_) {
       // TODO use the right bound constants? or kill bound constants?
-      if (auto *decl = mod->GetDecl(id)) {
-        matching_decls.emplace_back(decl,
-                                    mod->type_of(ast::BoundConstants{}, decl));
+      if (auto exports_iter = exports->find(id);
+          exports_iter != exports->end()) {
+        decls.insert(decls.end(), exports_iter->second.begin(),
+                     exports_iter->second.end());
+      }
+    }
+  }
+  lookup.decls_ = &decls;
+  return decls;
+}
+
+base::vector<ast::Declaration *> Scope::NestedDeclsWithId(Symbol id) const {
+  base::vector<ast::Declaration *> nested_decls;
+  std::lock_guard lock(root_->mtx_);
+  auto iter = root_->tree_decls_.find(id);
+  if (iter == root_->tree_decls_.end()) { return nested_decls; }
+  for (auto *decl : iter->second) {
+    for (auto *scope_ptr = decl->scope_->parent; scope_ptr != nullptr;
+         scope_ptr      = scope_ptr->parent) {
+      if (scope_ptr == this) {
+        nested_decls.push_back(decl);
+        break;
       }
     }
   }
-  return matching_decls;
+  return nested_decls;
+}
+
+type::Type const *DeclType(type::Typed<ast::Declaration *> decl, Context *ctx) {
+  if (decl.type() != nullptr) { return decl.type(); }
+  if (auto *t = ctx->type_of(decl.get())) { return t; }
+  // TODO This will call VerifyType once if it's correct, but *every* time if
+  // it's incorrect. Fix this.
+  return decl.get()->VerifyType(ctx).type_;
 }
 
 ExecScope::ExecScope(Scope *parent) : Scope(parent) {
@@ -1,11 +1,15 @@
 #ifndef ICARUS_SCOPE_H
 #define ICARUS_SCOPE_H
 
+#include <atomic>
+#include <deque>
 #include <iosfwd>
+#include <mutex>
 #include <unordered_set>
 #include "base/container/unordered_map.h"
 #include "base/container/vector.h"
 #include "base/util.h"
+#include "symbol.h"
 #include "type/typed_value.h"
 
 struct Context;
@@ -31,9 +35,14 @@ struct DeclScope;
 struct ExecScope;
 struct FnScope;
 
+// The declarations a module exports, keyed on name, along with their types.
+using ExportTable =
+    base::unordered_map<Symbol, base::vector<type::Typed<ast::Declaration *>>>;
+
 struct Scope : public base::Cast<Scope> {
   Scope() = delete;
-  Scope(Scope *parent) : parent(parent) {}
+  Scope(Scope *parent)
+      : parent(parent), root_(parent ? parent->root_ : this) {}
   virtual ~Scope() {}
 
   template <typename ScopeType>
@@ -41,24 +50,72 @@ struct Scope : public base::Cast<Scope> {
     return std::make_unique<ScopeType>(this);
   }
 
-  base::vector<type::Typed<ast::Declaration *>> AllDeclsWithId(
-      std::string const &id, Context *ctx) const;
+  // Returns every declaration of `id` visible from this scope, innermost
+  // first. Each scope's own declarations precede those exported by the modules
+  // it embeds. Only the exported declarations come with their types, since the
+  // types of the rest depend on the bound constants. See `DeclType`.
+  //
+  // The list is cached. It is not updated when declarations are added, but it
+  // stays valid for as long as the scope does.
+  base::vector<type::Typed<ast::Declaration *>> const &AllDeclsWithId(
+      Symbol id) const;
+
+  // Returns every declaration of `id` in scopes nested within this one, not
+  // including this one.
+  base::vector<ast::Declaration *> NestedDeclsWithId(Symbol id) const;
 
   Module const *module() const;
 
   void InsertDecl(ast::Declaration *decl);
+  void EmbedModule(Module const *mod);
   void MakeAllDestructions(Context *ctx);
 
   FnScope *ContainingFnScope();
-  std::unordered_set<std::string> shadowed_decls_;
-  base::unordered_map<std::string, base::vector<ast::Declaration *>> decls_;
-  base::unordered_map<std::string, base::vector<ast::Declaration *>>
-      child_decls_;
+  std::unordered_set<Symbol> shadowed_decls_;
+  base::unordered_map<Symbol, base::vector<ast::Declaration *>> decls_;
 
   std::unordered_set<Module const *> embedded_modules_;
   Scope *parent = nullptr;
+
+ private:
+  // A cached result of `AllDeclsWithId`. Marked stale whenever a declaration
+  // of its name is added to the scope or one enclosing it, or a module is
+  // embedded in one of them.
+  struct CachedLookup {
+    std::atomic<bool> valid_ = false;
+    base::vector<type::Typed<ast::Declaration *>> const *decls_ = nullptr;
+  };
+
+  // Marks stale every lookup which depends on this scope's declarations of
+  // `id`. Must be called with `mtx_` held.
+  void InvalidateLookups(Symbol id);
+
+  // The outermost scope containing this one.
+  Scope *root_;
+
+  // Guards `decls_`, `embedded_modules_` and everything below, since
+  // declarations in the same scope may be verified on different threads, and
+  // function bodies parsed lazily add declarations as they are verified.
+  mutable std::mutex mtx_;
+  mutable base::unordered_map<Symbol, CachedLookup> lookups_;
+  // Every list ever cached in `lookups_`. A stale list is replaced rather than
+  // updated, so that references to it remain valid.
+  mutable std::deque<base::vector<type::Typed<ast::Declaration *>>> lists_;
+  // For each name, the lookups cached in this scope or in scopes nested within
+  // it which include this scope's declarations of that name. Scopes are only
+  // destroyed along with the whole tree, so these never dangle.
+  mutable base::unordered_map<Symbol, base::vector<CachedLookup *>>
+      dependents_;
+  // The exports of each module in `embedded_modules_`.
+  base::vector<ExportTable const *> embedded_exports_;
+  // Only used on the root: every declaration in the tree, keyed on name.
+  base::unordered_map<Symbol, base::vector<ast::Declaration *>> tree_decls_;
 };
 
+// Returns the type of `decl`, which was returned by `AllDeclsWithId`,
+// verifying the declaration first if it has not been already.
+type::Type const *DeclType(type::Typed<ast::Declaration *> decl, Context *ctx);
+
 struct DeclScope : public Scope {
   DeclScope(Scope *parent) : Scope(parent) {}
   ~DeclScope() override {}
@@ -0,0 +1,41 @@
+#include "symbol.h"
+
+#include <atomic>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+#include "base/guarded.h"
+
+namespace {
+// Interning is split across shards, chosen by the hash of the text, so that
+// modules lexed in parallel rarely wait on one another.
+constexpr size_t kNumShards = 16;
+
+struct Shard {
+  std::unordered_map<std::string_view, Symbol::Entry const *> entries_;
+  // Deques, so that neither the entries nor the strings they view ever move.
+  std::deque<std::string> texts_;
+  std::deque<Symbol::Entry> storage_;
+};
+
+base::guarded<Shard> shards[kNumShards];
+std::atomic<u32> next_id{1};
+}  // namespace
+
+Symbol::Symbol(std::string_view text) : entry_(&kEmpty) {
+  if (text.empty()) { return; }
+  size_t hash = std::hash<std::string_view>{}(text);
+  auto shard  = shards[hash % kNumShards].lock();
+  if (auto iter = shard->entries_.find(text); iter != shard->entries_.end()) {
+    entry_ = iter->second;
+    return;
+  }
+  std::string_view stored = shard->texts_.emplace_back(text);
+  entry_                  = &shard->storage_.emplace_back(
+      Entry{next_id.fetch_add(1, std::memory_order_relaxed), stored});
+  shard->entries_.emplace(stored, entry_);
+}
+
+std::ostream &operator<<(std::ostream &os, Symbol s) { return os << s.get(); }
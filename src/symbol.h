@@ -0,0 +1,56 @@
+#ifndef ICARUS_SYMBOL_H
+#define ICARUS_SYMBOL_H
+
+#include <functional>
+#include <iosfwd>
+#include <string_view>
+
+#include "base/types.h"
+
+// An identifier, interned in a table shared by every thread. Each distinct
+// spelling is stored once and given a small integer id, so symbols compare
+// and hash as integers, and copying one is as cheap as copying a pointer.
+struct Symbol {
+  struct Entry {
+    u32 id_;
+    std::string_view text_;
+  };
+
+  // The empty symbol.
+  constexpr Symbol() : entry_(&kEmpty) {}
+  explicit Symbol(std::string_view text);
+
+  u32 id() const { return entry_->id_; }
+  std::string_view get() const { return entry_->text_; }
+  bool empty() const { return entry_ == &kEmpty; }
+
+  friend bool operator==(Symbol lhs, Symbol rhs) {
+    return lhs.entry_ == rhs.entry_;
+  }
+  friend bool operator!=(Symbol lhs, Symbol rhs) { return !(lhs == rhs); }
+
+  // For comparing against fixed names. Compares the text, so prefer comparing
+  // against an interned `Symbol` on hot paths.
+  friend bool operator==(Symbol lhs, std::string_view rhs) {
+    return lhs.get() == rhs;
+  }
+  friend bool operator!=(Symbol lhs, std::string_view rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  static constexpr Entry kEmpty{0, ""};
+
+  Entry const *entry_;
+};
+
+std::ostream &operator<<(std::ostream &os, Symbol s);
+
+namespace std {
+template <>
+struct hash<Symbol> {
+  size_t operator()(Symbol s) const { return s.id(); }
+};
+}  // namespace std
+
+#endif  // ICARUS_SYMBOL_H
@@ -0,0 +1,159 @@
+#include "time_passes.h"
+
+#include <time.h>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+#include "base/guarded.h"
+#include "base/trace.h"
+
+namespace time_passes {
+bool enabled            = false;
+char const *json_output = nullptr;
+
+namespace internal {
+std::atomic<u64> counters[kNumCounters];
+}  // namespace internal
+
+namespace {
+constexpr char const *kPhaseNames[kNumPhases] = {
+    "parse",
+    "assign_scope",
+    "verify_type",
+    "validate",
+    "emit_ir",
+    "complete_all",
+    "compute_invariants",
+    "check_invariants",
+    "emit_llvm",
+};
+
+constexpr char const *kCounterNames[kNumCounters] = {
+    "ast_nodes", "types_interned", "ir_funcs", "cmds",
+    "compile_time_evaluations", "cached_evaluations",
+};
+
+struct PhaseTime {
+  std::chrono::nanoseconds wall_{0};
+  std::chrono::nanoseconds cpu_{0};
+  bool ran_ = false;
+
+  PhaseTime &operator+=(PhaseTime const &rhs) {
+    wall_ += rhs.wall_;
+    cpu_ += rhs.cpu_;
+    ran_ |= rhs.ran_;
+    return *this;
+  }
+};
+using ModuleTimes = std::array<PhaseTime, kNumPhases>;
+
+// Keyed on module name so that the report is ordered deterministically.
+base::guarded<std::map<std::string, ModuleTimes>> module_times;
+
+std::chrono::nanoseconds ThreadCpuTime() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+double Millis(std::chrono::nanoseconds ns) {
+  return std::chrono::duration<double, std::milli>(ns).count();
+}
+
+void PrintTimes(ModuleTimes const &times) {
+  PhaseTime total;
+  std::fprintf(stderr, "  %-20s %12s %12s\n", "phase", "wall (ms)",
+               "cpu (ms)");
+  for (size_t i = 0; i < kNumPhases; ++i) {
+    if (!times[i].ran_) { continue; }
+    std::fprintf(stderr, "  %-20s %12.3f %12.3f\n", kPhaseNames[i],
+                 Millis(times[i].wall_), Millis(times[i].cpu_));
+    total += times[i];
+  }
+  std::fprintf(stderr, "  %-20s %12.3f %12.3f\n", "total", Millis(total.wall_),
+               Millis(total.cpu_));
+}
+
+void WriteJson(std::map<std::string, ModuleTimes> const &all_times,
+               char const *path) {
+  std::ofstream os(path);
+  if (!os) {
+    std::fprintf(stderr, "Failed to open \"%s\" for writing.\n", path);
+    return;
+  }
+
+  os << "{\n  \"modules\": [";
+  char const *module_sep = "\n";
+  for (auto const & [ name, times ] : all_times) {
+    os << module_sep << "    {\"path\": \"" << base::trace::JsonEscape(name)
+       << "\", \"phases\": {";
+    char const *phase_sep = "";
+    for (size_t i = 0; i < kNumPhases; ++i) {
+      if (!times[i].ran_) { continue; }
+      os << phase_sep << "\"" << kPhaseNames[i]
+         << "\": {\"wall_ms\": " << Millis(times[i].wall_)
+         << ", \"cpu_ms\": " << Millis(times[i].cpu_) << "}";
+      phase_sep = ", ";
+    }
+    os << "}}";
+    module_sep = ",\n";
+  }
+  os << "\n  ],\n  \"counters\": {";
+  for (size_t i = 0; i < kNumCounters; ++i) {
+    os << (i == 0 ? "" : ", ") << "\"" << kCounterNames[i]
+       << "\": " << internal::counters[i].load();
+  }
+  os << "}\n}\n";
+}
+}  // namespace
+
+void PhaseTimer::Start(Phase phase) {
+  if (!enabled && !base::trace::enabled) { return; }
+  Stop();
+  running_     = true;
+  phase_       = phase;
+  wall_start_  = std::chrono::steady_clock::now();
+  cpu_start_   = ThreadCpuTime();
+  trace_start_ = base::trace::Now();
+}
+
+void PhaseTimer::Stop() {
+  if (!running_) { return; }
+  running_ = false;
+  base::trace::Complete("phase", kPhaseNames[static_cast<size_t>(phase_)],
+                        trace_start_, module_name_);
+  if (!enabled) { return; }
+
+  PhaseTime elapsed;
+  elapsed.wall_ = std::chrono::steady_clock::now() - wall_start_;
+  elapsed.cpu_  = ThreadCpuTime() - cpu_start_;
+  elapsed.ran_  = true;
+  (*module_times.lock())[module_name_][static_cast<size_t>(phase_)] += elapsed;
+}
+
+void Report() {
+  if (!enabled) { return; }
+  auto handle = module_times.lock();
+
+  ModuleTimes totals;
+  for (auto const & [ name, times ] : *handle) {
+    std::fprintf(stderr, "\n%s\n", name.c_str());
+    PrintTimes(times);
+    for (size_t i = 0; i < kNumPhases; ++i) { totals[i] += times[i]; }
+  }
+  if (handle->size() > 1) {
+    std::fputs("\nAll modules\n", stderr);
+    PrintTimes(totals);
+  }
+
+  std::fputs("\n", stderr);
+  for (size_t i = 0; i < kNumCounters; ++i) {
+    std::fprintf(stderr, "  %-26s %12lu\n", kCounterNames[i],
+                 static_cast<unsigned long>(internal::counters[i].load()));
+  }
+
+  if (json_output != nullptr) { WriteJson(*handle, json_output); }
+}
+}  // namespace time_passes
@@ -0,0 +1,80 @@
+#ifndef ICARUS_TIME_PASSES_H
+#define ICARUS_TIME_PASSES_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "base/types.h"
+
+// Collects the data reported by `--time-passes`: wall and CPU time spent in
+// each phase of compiling each module, along with global counts of the work
+// done. When the flag is off, every entry point reduces to a single branch.
+namespace time_passes {
+// Set by `--time-passes`.
+extern bool enabled;
+// Set by `--time-passes-json`. If non-null, the report is also written to this
+// path as JSON.
+extern char const *json_output;
+
+enum class Phase : u8 {
+  Parse,
+  AssignScope,
+  VerifyType,
+  Validate,
+  EmitIR,
+  CompleteAll,
+  ComputeInvariants,
+  CheckInvariants,
+  EmitLlvm,
+};
+constexpr size_t kNumPhases = static_cast<size_t>(Phase::EmitLlvm) + 1;
+
+enum class Counter : u8 {
+  AstNodes,
+  TypesInterned,
+  IrFuncs,
+  Cmds,
+  CompileTimeEvaluations,
+  CachedEvaluations,
+};
+constexpr size_t kNumCounters =
+    static_cast<size_t>(Counter::CachedEvaluations) + 1;
+
+namespace internal {
+extern std::atomic<u64> counters[kNumCounters];
+}  // namespace internal
+
+inline void Count(Counter c) {
+  if (!enabled) { return; }
+  internal::counters[static_cast<size_t>(c)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+// Times the phases of compiling a single module, and records each phase as a
+// span when tracing. Each call to `Start` ends the phase started before it, as
+// does destroying the timer. Must be used from a single thread, since CPU time
+// is measured for the calling thread only.
+struct PhaseTimer {
+  explicit PhaseTimer(std::string module_name)
+      : module_name_(std::move(module_name)) {}
+  ~PhaseTimer() { Stop(); }
+
+  void Start(Phase phase);
+  void Stop();
+
+ private:
+  std::string module_name_;
+  bool running_ = false;
+  Phase phase_  = Phase::Parse;
+  std::chrono::steady_clock::time_point wall_start_;
+  std::chrono::nanoseconds cpu_start_{0};
+  u64 trace_start_ = 0;
+};
+
+// Prints a table of everything recorded so far to stderr and, if requested,
+// writes it to `json_output`. Does nothing unless `enabled` is set.
+void Report();
+}  // namespace time_passes
+
+#endif  // ICARUS_TIME_PASSES_H
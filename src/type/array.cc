@@ -9,6 +9,7 @@
 #include "ir/func.h"
 #include "ir/phi.h"
 #include "module.h"
+#include "time_passes.h"
 #include "type/function.h"
 #include "type/pointer.h"
 
@@ -107,10 +108,11 @@ static base::guarded<
     fixed_arrays_;
 const Array *Arr(Type const *t, size_t len) {
   auto handle = fixed_arrays_.lock();
-  return &(*handle)[t]
-              .emplace(std::piecewise_construct, std::forward_as_tuple(len),
-                       std::forward_as_tuple(t, len))
-              .first->second;
+  auto[iter, inserted] =
+      (*handle)[t].emplace(std::piecewise_construct, std::forward_as_tuple(len),
+                           std::forward_as_tuple(t, len));
+  if (inserted) { time_passes::Count(time_passes::Counter::TypesInterned); }
+  return &iter->second;
 }
 
 void Array::defining_modules(
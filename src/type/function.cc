@@ -4,6 +4,7 @@
 #include "base/guarded.h"
 #include "ir/cmd.h"
 #include "ir/val.h"
+#include "time_passes.h"
 
 namespace type {
 
@@ -38,9 +39,10 @@ Function const *Func(base::vector<Type const *> in,
                      base::vector<Type const *> out) {
   // TODO if void is unit in some way we shouldn't do this.
   auto f = Function(in, out);
-  return &(*funcs_.lock())[std::move(in)]
-              .emplace(std::move(out), std::move(f))
-              .first->second;
+  auto[iter, inserted] =
+      (*funcs_.lock())[std::move(in)].emplace(std::move(out), std::move(f));
+  if (inserted) { time_passes::Count(time_passes::Counter::TypesInterned); }
+  return &iter->second;
 }
 
 void Function::EmitCopyAssign(Type const *from_type, ir::Val const &from,
@@ -3,6 +3,7 @@
 #include "base/container/unordered_map.h"
 #include "base/guarded.h"
 #include "ir/cmd.h"
+#include "time_passes.h"
 #include "type/function.h"
 
 namespace type {
@@ -10,13 +11,17 @@ namespace type {
 static base::guarded<base::unordered_map<Type const *, Pointer const>>
     pointers_;
 Pointer const *Ptr(Type const *t) {
-  return &pointers_.lock()->emplace(t, Pointer(t)).first->second;
+  auto[iter, inserted] = pointers_.lock()->emplace(t, Pointer(t));
+  if (inserted) { time_passes::Count(time_passes::Counter::TypesInterned); }
+  return &iter->second;
 }
 
 static base::guarded<base::unordered_map<Type const *, BufferPointer const>>
     buffer_pointers_;
 BufferPointer const *BufPtr(Type const *t) {
-  return &buffer_pointers_.lock()->emplace(t, BufferPointer(t)).first->second;
+  auto[iter, inserted] = buffer_pointers_.lock()->emplace(t, BufferPointer(t));
+  if (inserted) { time_passes::Count(time_passes::Counter::TypesInterned); }
+  return &iter->second;
 }
 
 void Pointer::EmitCopyAssign(Type const *from_type, ir::Val const &from,
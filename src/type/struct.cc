@@ -25,11 +25,12 @@ static constexpr char const *Name() {
 
 static std::optional<ir::AnyFunc> SpecialFunction(Struct const *s, char const *symbol,
                                                 Context *ctx) {
+  static Symbol const kDestroy("~");
   auto *ptr_to_s = Ptr(s);
-  for (auto &decl : s->scope_->AllDeclsWithId("~", ctx)) {
+  for (auto const &decl : s->scope_->AllDeclsWithId(kDestroy)) {
     // Note: there cannot be more than one declaration with the correct type
     // because our shadowing checks would have caught it.
-    auto *fn_type = decl.type()->if_as<Function>();
+    auto *fn_type = DeclType(decl, ctx)->if_as<Function>();
     if (fn_type == nullptr) { continue; }
     if (fn_type->input.front() != ptr_to_s) { continue; }
     return std::get<ir::AnyFunc>(decl.get()->EmitIR(ctx)[0].value);
@@ -11,6 +11,7 @@
 #include "ir/components.h"
 #include "ir/func.h"
 #include "module.h"
+#include "time_passes.h"
 #include "type/function.h"
 #include "type/pointer.h"
 
@@ -78,6 +79,7 @@ Type const *Tup(base::vector<Type const *> entries) {
   if (entries.size() == 1) { return entries[0]; }
   Tuple tup(entries);
   auto[iter, success] = tups_.lock()->emplace(std::move(entries), std::move(tup));
+  if (success) { time_passes::Count(time_passes::Counter::TypesInterned); }
   return &iter->second;
 }
 
@@ -8,6 +8,7 @@
 #include "ir/arguments.h"
 #include "ir/components.h"
 #include "ir/func.h"
+#include "time_passes.h"
 
 namespace type {
 
@@ -46,11 +47,11 @@ Type const *Var(base::vector<Type const *> variants) {
 
   if (variants.size() == 1) { return variants.front(); }
 
-  return &variants_.lock()
-              ->emplace(std::piecewise_construct,
-                        std::forward_as_tuple(variants),
-                        std::forward_as_tuple(variants))
-              .first->second;
+  auto[iter, inserted] = variants_.lock()->emplace(
+      std::piecewise_construct, std::forward_as_tuple(variants),
+      std::forward_as_tuple(variants));
+  if (inserted) { time_passes::Count(time_passes::Counter::TypesInterned); }
+  return &iter->second;
 }
 
 void Variant::EmitDestroy(ir::Register reg, Context *ctx) const {